@@ -15,31 +15,126 @@
  */
 
 #include "tdd_code.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Sestaví podgraf indukovaný uzly s danými hustými indexy.
+ *
+ * @param[in] view    CSR pohled celého grafu
+ * @param[in] members husté indexy uzlů podgrafu bez duplicit
+ * @param[in] bitset  bitová maska příslušnosti uzlů k podgrafu
+ * @return kompaktní CSR podgraf
+ */
+static GraphCsr induce(const GraphCsr& view, const std::vector<size_t>& members, const std::vector<uint64_t>& bitset){
+    GraphCsr sub;
+    sub.ids.reserve(members.size());
+    sub.index.reserve(members.size());
+    for (size_t idx : members){
+        sub.index.emplace(view.ids[idx], sub.ids.size());
+        sub.ids.push_back(view.ids[idx]);
+    }
+
+    // Keep only neighbours whose bit is set
+    sub.offsets.reserve(members.size() + 1);
+    sub.offsets.push_back(0);
+    for (size_t idx : members){
+        for (size_t e = view.offsets[idx]; e < view.offsets[idx + 1]; e++){
+            size_t u = view.neighbors[e];
+            if (bitset[u >> 6] & (uint64_t(1) << (u & 63)))
+                sub.neighbors.push_back(sub.index[view.ids[u]]);
+        }
+        sub.offsets.push_back(sub.neighbors.size());
+    }
+
+    return sub;
+}
+
+Graph::GraphData::~GraphData(){
+    // Dynamically free the graph nodes
+    for (Node* node : this->graph_nodes)
+        delete node;
+}
 
 Graph::Graph(){
-    // Initialize empty graph
-    this->graph_nodes = {};
-    this->graph_edges = {};
+    // Initialize empty graph, shared until the first change
+    this->data = emptyData();
+}
+
+Graph::Graph(const Graph& other){
+    // Share the storage, the copy is made on the first change
+    this->data = other.data;
+}
+
+Graph::Graph(Graph&& other) noexcept{
+    // Steal the storage and leave the other graph empty
+    this->data = std::move(other.data);
+    other.data = emptyData();
+}
+
+Graph& Graph::operator=(const Graph& other){
+    // Share the storage, the copy is made on the first change
+    this->data = other.data;
+    return *this;
+}
+
+Graph& Graph::operator=(Graph&& other) noexcept{
+    // Swap the storage, the old one is released together with the other graph
+    this->data.swap(other.data);
+    return *this;
 }
 
 Graph::~Graph(){
-    // Clear all nodes and edges from the graph
-    this->clear();
+    // Nodes are freed together with the last owner of the storage
+}
+
+const std::shared_ptr<Graph::GraphData>& Graph::emptyData(){
+    static const std::shared_ptr<GraphData> empty = std::make_shared<GraphData>();
+    return empty;
+}
+
+void Graph::detach(){
+    // Storage is not shared, it may be changed in place
+    if (this->data.use_count() == 1)
+        return;
+
+    // Deep copy of the nodes, edges and the immutable CSR view can be shared
+    auto copy = std::make_shared<GraphData>();
+    copy->graph_nodes.reserve(this->data->graph_nodes.size());
+    for (Node* node : this->data->graph_nodes)
+        copy->graph_nodes.push_back(new Node(*node));
+    copy->graph_edges = this->data->graph_edges;
+    {
+        std::lock_guard<std::mutex> lock(this->data->csr_mutex);
+        copy->csr_cache = this->data->csr_cache;
+    }
+
+    this->data = copy;
 }
 
 std::vector<Node*> Graph::nodes() {
+    // Nodes may be changed through the pointers
+    detach();
+
+    // Return vector of all graph nodes
+    return this->data->graph_nodes;
+}
+
+std::vector<const Node*> Graph::nodes() const{
     // Return vector of all graph nodes
-    return this->graph_nodes;
+    return std::vector<const Node*>(this->data->graph_nodes.begin(), this->data->graph_nodes.end());
 }
 
 std::vector<Edge> Graph::edges() const{
     // Return vector of all graph edges
-    return this->graph_edges;
+    return this->data->graph_edges;
 }
 
 Node* Graph::addNode(size_t nodeId) {
+    detach();
+
     // Check if the node exists
-    for (Node* node_i : this->graph_nodes){
+    for (Node* node_i : this->data->graph_nodes){
         if (node_i->id == nodeId) 
             return nullptr;
     }
@@ -51,17 +146,21 @@ Node* Graph::addNode(size_t nodeId) {
     new_node->degree = 0;
 
     // Add node to the graph
-    this->graph_nodes.push_back(new_node);
+    this->data->graph_nodes.push_back(new_node);
+    this->data->csr_cache.reset();
     return new_node;
 }
 
 bool Graph::addEdge(const Edge& edge){
+    detach();
+
     // Check if edge is a loop or duplicit 
     if (edge.a == edge.b || containsEdge(edge))
         return false;
 
     // Add edge to the graph
-    this->graph_edges.push_back(edge);
+    this->data->graph_edges.push_back(edge);
+    this->data->csr_cache.reset();
     // Check if edge nodes exist
     addNode(edge.a);
     addNode(edge.b);
@@ -76,8 +175,21 @@ void Graph::addMultipleEdges(const std::vector<Edge>& edges) {
 }
 
 Node* Graph::getNode(size_t nodeId){
+    // Node may be changed through the pointer
+    detach();
+
     // Search for node in the graph
-    for (Node* node_i : this->graph_nodes){
+    for (Node* node_i : this->data->graph_nodes){
+        if (node_i->id == nodeId)
+            return node_i;
+    }
+
+    return nullptr;
+}
+
+const Node* Graph::getNode(size_t nodeId) const{
+    // Search for node in the graph
+    for (const Node* node_i : this->data->graph_nodes){
         if (node_i->id == nodeId)
             return node_i;
     }
@@ -87,7 +199,7 @@ Node* Graph::getNode(size_t nodeId){
 
 bool Graph::containsEdge(const Edge& edge) const{
     // Check if edge exists
-    for (Edge edge_i : this->graph_edges){
+    for (Edge edge_i : this->data->graph_edges){
         if ((edge_i.a == edge.a && edge_i.b == edge.b) || (edge_i.a == edge.b && edge_i.b == edge.a))
             return true;
     }
@@ -96,20 +208,23 @@ bool Graph::containsEdge(const Edge& edge) const{
 }
 
 void Graph::removeNode(size_t nodeId){
+    detach();
+
     // Search for node in the graph
-    for (int i = this->graph_nodes.size() - 1; i >= 0; i--){
-        if (this->graph_nodes[i]->id == nodeId){
+    for (int i = this->data->graph_nodes.size() - 1; i >= 0; i--){
+        if (this->data->graph_nodes[i]->id == nodeId){
             // Search edges connected to the node
-            for (int j = this->graph_edges.size() - 1; j >= 0; j--){
-                if (this->graph_edges[j].a == this->graph_nodes[i]->id || this->graph_edges[j].b == this->graph_nodes[i]->id ){
+            for (int j = this->data->graph_edges.size() - 1; j >= 0; j--){
+                if (this->data->graph_edges[j].a == this->data->graph_nodes[i]->id || this->data->graph_edges[j].b == this->data->graph_nodes[i]->id ){
                     // Remove edges connected to the node
-                    this->graph_edges.erase(this->graph_edges.begin() + j);
+                    this->data->graph_edges.erase(this->data->graph_edges.begin() + j);
                 }
             }
 
             // Remove the node
-            delete this->graph_nodes[i];
-            this->graph_nodes.erase(this->graph_nodes.begin() + i);
+            delete this->data->graph_nodes[i];
+            this->data->graph_nodes.erase(this->data->graph_nodes.begin() + i);
+            this->data->csr_cache.reset();
             return;
         }
     }
@@ -119,11 +234,14 @@ void Graph::removeNode(size_t nodeId){
 }
 
 void Graph::removeEdge(const Edge& edge){
+    detach();
+
     // Search for edge in the graph
-    for (int i = this->graph_edges.size() - 1; i >= 0; i--){
-        if ((this->graph_edges[i].a == edge.a && this->graph_edges[i].b == edge.b) || (this->graph_edges[i].a == edge.b && this->graph_edges[i].b == edge.a)){
+    for (int i = this->data->graph_edges.size() - 1; i >= 0; i--){
+        if ((this->data->graph_edges[i].a == edge.a && this->data->graph_edges[i].b == edge.b) || (this->data->graph_edges[i].a == edge.b && this->data->graph_edges[i].b == edge.a)){
             // Remove the edge
-            this->graph_edges.erase(this->graph_edges.begin() + i );
+            this->data->graph_edges.erase(this->data->graph_edges.begin() + i );
+            this->data->csr_cache.reset();
             return;
         }
     }
@@ -134,12 +252,12 @@ void Graph::removeEdge(const Edge& edge){
 
 size_t Graph::nodeCount() const{
     // Return nodes count
-    return this->graph_nodes.size();
+    return this->data->graph_nodes.size();
 }
 
 size_t Graph::edgeCount() const{
     // Return edges count
-    return this->graph_edges.size();
+    return this->data->graph_edges.size();
 }
 
 size_t Graph::nodeDegree(size_t nodeId) const{
@@ -147,7 +265,7 @@ size_t Graph::nodeDegree(size_t nodeId) const{
     size_t count = 0;
     
     // Check node degree
-    for (Edge edge : this->graph_edges){
+    for (Edge edge : this->data->graph_edges){
         if (edge.a == nodeId || edge.b == nodeId)
             count++;
     }
@@ -164,20 +282,22 @@ size_t Graph::graphDegree() const {
     size_t max_degree = 0;
 
     // Find max graph degree
-    for (Node* node_i : this->graph_nodes)
+    for (Node* node_i : this->data->graph_nodes)
         max_degree = std::max(max_degree, nodeDegree(node_i->id));
 
     return max_degree;
 }
 
 void Graph::coloring(){
+    detach();
+
     // Get max colors count
     size_t colors_max = graphDegree() + 1;
     // Starting coloring value
     size_t current_color = 1;
 
     // Loop through all nodes and color them
-    for (Node* node : this->graph_nodes){
+    for (Node* node : this->data->graph_nodes){
         node->color = current_color;
 
         // Reset coloring value to 1 if needed
@@ -189,13 +309,335 @@ void Graph::coloring(){
     }
 }
 void Graph::clear() {
-    // Dynamically free the graph nodes
-    for (Node* node : this->graph_nodes)
-        delete node;
+    // Drop the reference, nodes are freed together with the last owner
+    this->data = emptyData();
+}
+
+size_t GraphCsr::indexOf(size_t nodeId) const{
+    // Translate node id to its dense index
+    auto it = this->index.find(nodeId);
+    if (it == this->index.end())
+        throw std::out_of_range("Error at function indexOf: Attempting to find a non-existent node!\n");
+
+    return it->second;
+}
+
+const GraphCsr& Graph::csr() const{
+    // Graphs sharing the storage may build the view concurrently
+    std::lock_guard<std::mutex> lock(this->data->csr_mutex);
+
+    // Reuse the view until the graph changes
+    if (this->data->csr_cache)
+        return *this->data->csr_cache;
+
+    auto view = std::make_shared<GraphCsr>();
+    size_t n = this->data->graph_nodes.size();
+
+    // Assign dense indices in the order of graph nodes
+    view->ids.reserve(n);
+    view->index.reserve(n);
+    for (Node* node_i : this->data->graph_nodes){
+        view->index.emplace(node_i->id, view->ids.size());
+        view->ids.push_back(node_i->id);
+    }
+
+    // Count degrees and turn them into row offsets
+    view->offsets.assign(n + 1, 0);
+    for (const Edge& edge : this->data->graph_edges){
+        view->offsets[view->index[edge.a] + 1]++;
+        view->offsets[view->index[edge.b] + 1]++;
+    }
+    for (size_t i = 0; i < n; i++)
+        view->offsets[i + 1] += view->offsets[i];
+
+    // Scatter both directions of every edge into its row
+    std::vector<size_t> fill(view->offsets.begin(), view->offsets.end() - 1);
+    view->neighbors.resize(view->offsets[n]);
+    for (const Edge& edge : this->data->graph_edges){
+        size_t a = view->index[edge.a];
+        size_t b = view->index[edge.b];
+        view->neighbors[fill[a]++] = b;
+        view->neighbors[fill[b]++] = a;
+    }
+
+    this->data->csr_cache = view;
+    return *view;
+}
+
+std::vector<std::vector<size_t>> Graph::distances(const std::vector<size_t>& sources) const{
+    const GraphCsr& view = csr();
+    size_t n = view.nodeCount();
+    std::vector<std::vector<size_t>> result(sources.size(), std::vector<size_t>(n, UNREACHABLE));
+
+    // One bit per source of the current batch
+    std::vector<uint64_t> seen(n), frontier(n), next(n);
+
+    for (size_t batch = 0; batch < sources.size(); batch += 64){
+        size_t width = std::min<size_t>(64, sources.size() - batch);
+        std::fill(seen.begin(), seen.end(), 0);
+        std::fill(frontier.begin(), frontier.end(), 0);
+
+        // Start every source of the batch at distance 0
+        for (size_t bit = 0; bit < width; bit++){
+            size_t idx = view.indexOf(sources[batch + bit]);
+            seen[idx] |= uint64_t(1) << bit;
+            frontier[idx] |= uint64_t(1) << bit;
+            result[batch + bit][idx] = 0;
+        }
+
+        for (size_t level = 1; ; level++){
+            // Push the whole frontier mask through each adjacency list once
+            std::fill(next.begin(), next.end(), 0);
+            for (size_t v = 0; v < n; v++){
+                uint64_t mask = frontier[v];
+                if (!mask)
+                    continue;
+                for (size_t e = view.offsets[v]; e < view.offsets[v + 1]; e++)
+                    next[view.neighbors[e]] |= mask;
+            }
+
+            // Keep only sources that reach the node for the first time
+            bool active = false;
+            for (size_t v = 0; v < n; v++){
+                uint64_t fresh = next[v] & ~seen[v];
+                frontier[v] = fresh;
+                if (!fresh)
+                    continue;
+                active = true;
+                seen[v] |= fresh;
+                while (fresh){
+                    result[batch + __builtin_ctzll(fresh)][v] = level;
+                    fresh &= fresh - 1;
+                }
+            }
+
+            if (!active)
+                break;
+        }
+    }
+
+    return result;
+}
+
+GraphCsr Graph::inducedSubgraph(const std::vector<size_t>& nodeIds) const{
+    const GraphCsr& view = csr();
+    std::vector<uint64_t> bitset((view.nodeCount() + 63) / 64);
+    std::vector<size_t> members;
+    members.reserve(nodeIds.size());
+
+    // Mark every requested node once
+    for (size_t nodeId : nodeIds){
+        size_t idx = view.indexOf(nodeId);
+        uint64_t bit = uint64_t(1) << (idx & 63);
+        if (bitset[idx >> 6] & bit)
+            continue;
+        bitset[idx >> 6] |= bit;
+        members.push_back(idx);
+    }
+
+    return induce(view, members, bitset);
+}
+
+GraphCsr Graph::egoNetwork(size_t nodeId, size_t k) const{
+    const GraphCsr& view = csr();
+    std::vector<uint64_t> bitset((view.nodeCount() + 63) / 64);
+
+    // Breadth-first search up to k hops, members double as the queue
+    size_t center = view.indexOf(nodeId);
+    std::vector<size_t> members = { center };
+    bitset[center >> 6] |= uint64_t(1) << (center & 63);
+    size_t level_begin = 0;
+    for (size_t level = 0; level < k && level_begin < members.size(); level++){
+        size_t level_end = members.size();
+        for (size_t i = level_begin; i < level_end; i++){
+            size_t v = members[i];
+            for (size_t e = view.offsets[v]; e < view.offsets[v + 1]; e++){
+                size_t u = view.neighbors[e];
+                uint64_t bit = uint64_t(1) << (u & 63);
+                if (bitset[u >> 6] & bit)
+                    continue;
+                bitset[u >> 6] |= bit;
+                members.push_back(u);
+            }
+        }
+        level_begin = level_end;
+    }
+
+    return induce(view, members, bitset);
+}
+
+std::vector<double> Graph::pageRank(double damping, double tolerance, size_t maxIterations) const{
+    // Check damping factor
+    if (!(damping >= 0.0 && damping <= 1.0))
+        throw std::invalid_argument("Error at function pageRank: Damping factor must lie in [0, 1]!\n");
+
+    const GraphCsr& view = csr();
+    const long long n = view.nodeCount();
+    if (n == 0)
+        return {};
+
+    const size_t* offsets = view.offsets.data();
+    const size_t* neighbors = view.neighbors.data();
+    std::vector<double> rank(n, 1.0 / n), contrib(n), next(n);
+
+    for (size_t iteration = 0; iteration < maxIterations; iteration++){
+        // Precompute what every node sends along each of its edges
+        double dangling = 0.0;
+#ifdef _OPENMP
+        #pragma omp parallel for reduction(+:dangling) schedule(static)
+#endif
+        for (long long v = 0; v < n; v++){
+            size_t degree = offsets[v + 1] - offsets[v];
+            if (degree)
+                contrib[v] = rank[v] / degree;
+            else {
+                contrib[v] = 0.0;
+                dangling += rank[v];
+            }
+        }
+
+        // Pull contributions of the neighbours into every node
+        const double base = (1.0 - damping + damping * dangling) / n;
+        double delta = 0.0;
+#ifdef _OPENMP
+        #pragma omp parallel for reduction(+:delta) schedule(dynamic, 1024)
+#endif
+        for (long long v = 0; v < n; v++){
+            double sum = 0.0;
+#ifdef _OPENMP
+            #pragma omp simd reduction(+:sum)
+#endif
+            for (size_t e = offsets[v]; e < offsets[v + 1]; e++)
+                sum += contrib[neighbors[e]];
+            next[v] = base + damping * sum;
+            delta += std::abs(next[v] - rank[v]);
+        }
+
+        rank.swap(next);
+        if (delta < tolerance)
+            break;
+    }
+
+    return rank;
+}
+
+StreamingGraph::StreamingGraph(uint64_t window, uint64_t segmentSpan){
+    // Initialize empty graph
+    this->window = window;
+    this->span = segmentSpan ? segmentSpan : std::max<uint64_t>(1, window / 16);
+    this->edge_count = 0;
+}
+
+bool StreamingGraph::addEdge(const Edge& edge, uint64_t timestamp){
+    // Check if edge is a loop
+    if (edge.a == edge.b)
+        return false;
+
+    // Open a new segment when the timestamp leaves the newest one (compared as a difference,
+    // the segment end may not fit into uint64_t)
+    if (this->segments.empty() || (timestamp >= this->segments.back().start &&
+                                   timestamp - this->segments.back().start >= this->span))
+        this->segments.push_back({ timestamp - timestamp % this->span, {} });
+    this->segments.back().edges.push_back(edge);
+
+    // Count the copy on both endpoints
+    size_t copies = ++this->adjacency[edge.a][edge.b];
+    ++this->adjacency[edge.b][edge.a];
+    if (copies > 1)
+        return false;
+
+    this->edge_count++;
+    return true;
+}
+
+size_t StreamingGraph::expire(uint64_t now){
+    size_t expired = 0;
+
+    // Drop whole segments whose newest possible edge (start + span - 1) is out of the window,
+    // i.e. now - start >= window + span - 1; the sum is never formed so it cannot overflow
+    while (!this->segments.empty() && now >= this->segments.front().start &&
+           now - this->segments.front().start >= this->window &&
+           now - this->segments.front().start - this->window >= this->span - 1){
+        for (const Edge& edge : this->segments.front().edges){
+            auto a = this->adjacency.find(edge.a);
+            auto b = this->adjacency.find(edge.b);
+            if (--a->second[edge.b] == 0){
+                // Last copy of the edge expired
+                a->second.erase(edge.b);
+                b->second.erase(edge.a);
+                this->edge_count--;
+                if (a->second.empty())
+                    this->adjacency.erase(a);
+                if (b->second.empty())
+                    this->adjacency.erase(b);
+            }
+            else
+                --b->second[edge.a];
+            expired++;
+        }
+        this->segments.pop_front();
+    }
+
+    return expired;
+}
+
+bool StreamingGraph::containsEdge(const Edge& edge) const{
+    // Check if edge exists
+    auto it = this->adjacency.find(edge.a);
+    return it != this->adjacency.end() && it->second.count(edge.b);
+}
+
+std::vector<size_t> StreamingGraph::neighbors(size_t nodeId) const{
+    auto it = this->adjacency.find(nodeId);
+    if (it == this->adjacency.end())
+        throw std::out_of_range("Error at function neighbors: Attempting to list neighbours of non-existent node!\n");
+
+    std::vector<size_t> result;
+    result.reserve(it->second.size());
+    for (const auto& neighbor : it->second)
+        result.push_back(neighbor.first);
+
+    return result;
+}
+
+size_t StreamingGraph::nodeDegree(size_t nodeId) const{
+    auto it = this->adjacency.find(nodeId);
+    if (it == this->adjacency.end())
+        throw std::out_of_range("Error at function nodeDegree: Attempting to count degree of non-existent node!\n");
+
+    return it->second.size();
+}
+
+size_t StreamingGraph::nodeCount() const{
+    // Return nodes count
+    return this->adjacency.size();
+}
+
+size_t StreamingGraph::edgeCount() const{
+    // Return edges count
+    return this->edge_count;
+}
+
+std::vector<Edge> StreamingGraph::edges() const{
+    std::vector<Edge> result;
+    result.reserve(this->edge_count);
+
+    // Report every edge once, from its smaller endpoint
+    for (const auto& node : this->adjacency){
+        for (const auto& neighbor : node.second){
+            if (node.first < neighbor.first)
+                result.emplace_back(node.first, neighbor.first);
+        }
+    }
+
+    return result;
+}
 
-    // Delete all vectors
-    this->graph_nodes.clear();
-    this->graph_edges.clear();
+void StreamingGraph::clear(){
+    // Delete all segments and adjacency lists
+    this->segments.clear();
+    this->adjacency.clear();
+    this->edge_count = 0;
 }
 
 /*** Konec souboru tdd_code.cpp ***/
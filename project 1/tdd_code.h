@@ -19,8 +19,13 @@
 #define TDD_CODE_H_
 
 #include <vector>
+#include <mutex>
+#include <memory>
+#include <cstdint>
 #include <stdexcept>
 #include <iostream>
+#include <deque>
+#include <unordered_map>
 
 /**
  * @brief reprezentace uzlu
@@ -78,18 +83,88 @@ public:
     }
 };
 
+/**
+ * @brief Kompaktní reprezentace grafu ve formátu CSR (compressed sparse row).
+ *
+ * Uzly jsou očíslovány hustými indexy 0 až n - 1 v pořadí, v jakém je vrací
+ * Graph::nodes(). Sousedé uzlu s indexem i leží v poli neighbors na pozicích
+ * offsets[i] až offsets[i + 1] - 1. Každá neorientovaná hrana je tedy uložena
+ * dvakrát.
+ */
+struct GraphCsr{
+    std::vector<size_t> ids;        ///< id uzlu pro každý hustý index
+    std::vector<size_t> offsets;    ///< začátky seznamů sousedů, velikost n + 1
+    std::vector<size_t> neighbors;  ///< husté indexy sousedů
+    std::unordered_map<size_t, size_t> index;  ///< převod id uzlu na hustý index
+
+    /**
+     * @return počet uzlů
+     */
+    size_t nodeCount() const { return ids.size(); }
+
+    /**
+     * @param[in] idx hustý index uzlu
+     * @return stupeň uzlu
+     */
+    size_t degree(size_t idx) const { return offsets[idx + 1] - offsets[idx]; }
+
+    /**
+     * @param[in] nodeId id uzlu
+     * @return hustý index uzlu
+     * @exception out_of_range pokud uzel v grafu neexistuje
+     */
+    size_t indexOf(size_t nodeId) const;
+};
+
 /**
  * @brief Třída reprezentující neorientovaný graf bez smyček.
  *
+ * Kopie grafu sdílejí uzly i hrany (copy-on-write), kopírování i přesun mají
+ * konstantní složitost. Vlastní kopie dat vznikne až při první změně grafu
+ * nebo při získání ukazatele na uzel, přes který lze uzel měnit. Konzumenti,
+ * kteří graf pouze čtou přes konstantní referenci, tak sdílí stejnou paměť
+ * i napříč vlákny.
+ *
+ * @warning Ukazatele na uzly získané před zkopírováním grafu nesmí být po
+ *          zkopírování použity ke změně uzlu, změna by se projevila i v kopii.
  */
 class Graph{
 public:
 
+    /// Vzdálenost nedosažitelného uzlu vrácená metodou distances.
+    static constexpr size_t UNREACHABLE = SIZE_MAX;
+
     /**
      * @brief konstruktor prázdného grafu
      */
     Graph();
 
+    /**
+     * @brief kopírovací konstruktor, kopie sdílí data s původním grafem
+     * @param[in] other kopírovaný graf
+     */
+    Graph(const Graph& other);
+
+    /**
+     * @brief přesouvací konstruktor, původní graf zůstane prázdný
+     * @param[in, out] other přesouvaný graf
+     */
+    Graph(Graph&& other) noexcept;
+
+    /**
+     * @brief kopírovací přiřazení, graf sdílí data s přiřazovaným grafem
+     * @param[in] other kopírovaný graf
+     * @return tento graf
+     */
+    Graph& operator=(const Graph& other);
+
+    /**
+     * @brief přesouvací přiřazení, graf si s přiřazovaným grafem vymění data
+     * @param[in, out] other přesouvaný graf
+     * @return tento graf
+     */
+    Graph& operator=(Graph&& other) noexcept;
+
     /**
      * @brief destruktor grafu
      */
@@ -100,6 +175,11 @@ public:
      */
     std::vector<Node*> nodes();
 
+    /**
+     * @return vektor ukazatelů na všechny uzly v grafu, sdílená data se nekopírují
+     */
+    std::vector<const Node*> nodes() const;
+
     /**
      * @return vektor všech hran v grafu
      */
@@ -138,6 +218,13 @@ public:
      */
     Node* getNode(size_t nodeId);
 
+    /**
+     * @brief Vrátí ukazatel na uzel s daným id, sdílená data se nekopírují.
+     * @param[in] nodeId	Id uzlu.
+     * @return Ukazatel na uzel nebo nullptr, pokud uzel neexistuje.
+     */
+    const Node* getNode(size_t nodeId) const;
+
     /**
      * @brief Zjistí, zda hrana existuje v grafu.
      * @param edge hrana, která nás zajímá
@@ -200,9 +287,188 @@ public:
      */
     void clear();
 
+    /**
+     * Vrátí CSR pohled na graf. Pohled je sestaven líně v čase O(V + E) a
+     * uložen, dokud se graf nezmění.
+     *
+     * @return CSR reprezentace grafu
+     */
+    const GraphCsr& csr() const;
+
+    /**
+     * Spočítá vzdálenosti (počet hran) ze zadaných zdrojových uzlů do všech
+     * uzlů grafu. Zdroje jsou zpracovány po dávkách 64 najednou
+     * (multi-source BFS) - každý uzel nese bitové masky navštívených zdrojů a
+     * aktuální fronty, takže jeden průchod seznamem sousedů obslouží všechny
+     * zdroje v dávce.
+     *
+     * @param[in] sources id zdrojových uzlů
+     * @return pro každý zdroj vektor vzdáleností v pořadí uzlů z nodes(),
+     *         nedosažitelné uzly mají vzdálenost UNREACHABLE
+     * @exception out_of_range pokud některý zdrojový uzel v grafu neexistuje
+     */
+    std::vector<std::vector<size_t>> distances(const std::vector<size_t>& sources) const;
+
+    /**
+     * Spočítá PageRank uzlů grafu. Iterace probíhá v režimu "pull" nad CSR
+     * pohledem: každý uzel sečte příspěvky svých sousedů ze souvislého pole,
+     * uzly jsou zpracovány paralelně (OpenMP, je-li k dispozici). Rank uzlů bez
+     * hran je rovnoměrně rozdělen mezi všechny uzly.
+     *
+     * @param[in] damping       tlumící faktor z intervalu [0, 1]
+     * @param[in] tolerance     iterace končí, když součet absolutních změn ranků
+     *                          klesne pod tuto mez
+     * @param[in] maxIterations maximální počet iterací
+     * @return rank uzlů v pořadí uzlů z nodes(), součet ranků je 1
+     * @exception invalid_argument pokud tlumící faktor neleží v intervalu [0, 1]
+     */
+    std::vector<double> pageRank(double damping = 0.85, double tolerance = 1e-9, size_t maxIterations = 100) const;
+
+    /**
+     * Vytvoří podgraf indukovaný zadanými uzly, tj. zadané uzly a všechny hrany
+     * grafu mezi nimi. Podgraf je sestaven z CSR pohledu v čase úměrném součtu
+     * stupňů vybraných uzlů, příslušnost uzlu k podgrafu se testuje bitovou
+     * maskou.
+     *
+     * @param[in] nodeIds id uzlů podgrafu, duplicitní id jsou ignorována
+     * @return kompaktní CSR podgraf, husté indexy odpovídají pořadí v nodeIds
+     * @exception out_of_range pokud některý uzel v grafu neexistuje
+     */
+    GraphCsr inducedSubgraph(const std::vector<size_t>& nodeIds) const;
+
+    /**
+     * Vytvoří ego síť uzlu, tj. podgraf indukovaný všemi uzly ve vzdálenosti
+     * nejvýše k od zadaného uzlu.
+     *
+     * @param[in] nodeId id středového uzlu
+     * @param[in] k      maximální vzdálenost od středového uzlu
+     * @return kompaktní CSR podgraf, středový uzel má hustý index 0 a uzly jsou
+     *         seřazeny podle vzdálenosti
+     * @exception out_of_range pokud uzel v grafu neexistuje
+     */
+    GraphCsr egoNetwork(size_t nodeId, size_t k) const;
+
+protected:
+    /**
+     * @brief Data grafu sdílená mezi jeho kopiemi.
+     */
+    struct GraphData{
+        std::vector<Node*> graph_nodes; // Vector of all graph nodes
+        std::vector<Edge> graph_edges; // Vector of all graph edges
+        std::shared_ptr<const GraphCsr> csr_cache; // Lazily built CSR view, reset on every change
+        std::mutex csr_mutex; // Guards building of the CSR view
+
+        ~GraphData();
+    };
+
+    /**
+     * @return sdílená data prázdného grafu
+     */
+    static const std::shared_ptr<GraphData>& emptyData();
+
+    /**
+     * Zajistí, že graf vlastní svá data výhradně, sdílená data zkopíruje.
+     */
+    void detach();
+
+    std::shared_ptr<GraphData> data; // Storage shared between copies
+};
+
+/**
+ * @brief Neorientovaný graf nad proudem hran s posuvným časovým oknem.
+ *
+ * Každá hrana nese časovou značku (nebo pořadové číslo) a v grafu zůstává,
+ * dokud neuplyne délka okna. Hrany jsou seskupeny do segmentů pevné časové
+ * délky uložených v kruhové frontě, expirace proto odstraňuje celé segmenty
+ * najednou s amortizovanou cenou O(1) na hranu. Stupně uzlů a seznamy sousedů
+ * jsou udržovány průběžně. Uzel v grafu existuje, dokud má alespoň jednu hranu.
+ */
+class StreamingGraph{
+public:
+
+    /**
+     * @brief konstruktor prázdného grafu
+     *
+     * @param[in] window      délka okna, hrana se značkou t je platná do času t + window
+     * @param[in] segmentSpan časová délka jednoho segmentu, hrana může přežít
+     *                        konec okna nejvýše o tuto dobu; 0 zvolí window / 16
+     */
+    explicit StreamingGraph(uint64_t window, uint64_t segmentSpan = 0);
+
+    /**
+     * Přidá hranu s danou časovou značkou. Značky by měly být neklesající,
+     * starší značka je přiřazena nejnovějšímu segmentu. Opakovaně přidaná
+     * hrana prodlouží svou platnost.
+     *
+     * @param[in] edge      hrana
+     * @param[in] timestamp časová značka hrany
+     * @return True pokud hrana v grafu dosud nebyla, false pro duplicitu nebo smyčku.
+     */
+    bool addEdge(const Edge& edge, uint64_t timestamp);
+
+    /**
+     * Odstraní všechny segmenty, jejichž hrany jsou v čase now již neplatné.
+     *
+     * @param[in] now aktuální čas
+     * @return počet odstraněných záznamů hran
+     */
+    size_t expire(uint64_t now);
+
+    /**
+     * @brief Zjistí, zda hrana existuje v grafu.
+     * @param edge hrana, která nás zajímá
+     * @return true pokud hrana existuje, jinak false
+     */
+    bool containsEdge(const Edge& edge) const;
+
+    /**
+     * @param[in] nodeId id uzlu
+     * @return id sousedů uzlu
+     * @exception out_of_range pokud uzel v grafu neexistuje
+     */
+    std::vector<size_t> neighbors(size_t nodeId) const;
+
+    /**
+     * @param[in] nodeId id uzlu
+     * @return počet hran, které mají tento uzel za svůj jeden koncový bod
+     * @exception out_of_range pokud uzel v grafu neexistuje
+     */
+    size_t nodeDegree(size_t nodeId) const;
+
+    /**
+     * @return počet uzlů v grafu
+     */
+    size_t nodeCount() const;
+
+    /**
+     * @return počet hran v grafu
+     */
+    size_t edgeCount() const;
+
+    /**
+     * @return vektor všech hran v grafu
+     */
+    std::vector<Edge> edges() const;
+
+    /**
+     * Smazání všech uzlů a hran v grafu.
+     */
+    void clear();
+
 protected:
-    std::vector<Node*> graph_nodes; // Vector of all graph nodes
-    std::vector<Edge> graph_edges; // Vector of all graph edges
+    /**
+     * @brief Hrany přidané v jednom časovém úseku.
+     */
+    struct Segment{
+        uint64_t start;           ///< první časová značka segmentu
+        std::vector<Edge> edges;  ///< hrany v pořadí přidání
+    };
+
+    uint64_t window; // Window length
+    uint64_t span; // Time span of one segment
+    size_t edge_count; // Number of distinct live edges
+    std::deque<Segment> segments; // Ring of segments, oldest first
+    std::unordered_map<size_t, std::unordered_map<size_t, size_t>> adjacency; // Neighbour -> number of live copies
 };
 
 #endif // TDD_CODE_H_
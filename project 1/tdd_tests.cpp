@@ -234,6 +234,160 @@ TEST_F(NonEmptyGraph, clear){
     EXPECT_EQ(edges.size(), 0);
 }
 
+TEST_F(NonEmptyGraph, csr){
+    const GraphCsr& view = graph.csr();
+    ASSERT_EQ(view.nodeCount(), 5);
+    EXPECT_EQ(view.neighbors.size(), 12);
+
+    size_t idx = view.indexOf(5);
+    EXPECT_EQ(view.ids[idx], 5);
+    EXPECT_EQ(view.degree(idx), 3);
+    std::vector<size_t> neighbors;
+    for (size_t e = view.offsets[idx]; e < view.offsets[idx + 1]; e++)
+        neighbors.push_back(view.ids[view.neighbors[e]]);
+    EXPECT_THAT(neighbors, UnorderedElementsAre(1, 6, 7));
+    EXPECT_THROW(view.indexOf(9), std::out_of_range);
+
+    graph.addEdge(Edge(5, 8));
+    EXPECT_EQ(graph.csr().degree(graph.csr().indexOf(5)), 4);
+}
+
+TEST_F(NonEmptyGraph, distances){
+    graph.addNode(9);
+    auto dist = graph.distances({ 1, 7 });
+    ASSERT_EQ(dist.size(), 2);
+
+    const GraphCsr& view = graph.csr();
+    EXPECT_EQ(dist[0][view.indexOf(1)], 0);
+    EXPECT_EQ(dist[0][view.indexOf(4)], 1);
+    EXPECT_EQ(dist[0][view.indexOf(5)], 1);
+    EXPECT_EQ(dist[0][view.indexOf(6)], 2);
+    EXPECT_EQ(dist[0][view.indexOf(7)], 2);
+    EXPECT_EQ(dist[0][view.indexOf(9)], Graph::UNREACHABLE);
+    EXPECT_EQ(dist[1][view.indexOf(1)], 2);
+    EXPECT_EQ(dist[1][view.indexOf(6)], 1);
+
+    EXPECT_THROW(graph.distances({ 1, 15 }), std::out_of_range);
+}
+
+TEST_F(NonEmptyGraph, pageRank){
+    auto rank = graph.pageRank();
+    ASSERT_EQ(rank.size(), 5);
+
+    const GraphCsr& view = graph.csr();
+    double total = 0.0;
+    for (double r : rank)
+        total += r;
+    EXPECT_NEAR(total, 1.0, 1e-9);
+
+    // Nodes 5 and 6 have the highest degree, 1 and 4 are symmetric
+    EXPECT_GT(rank[view.indexOf(5)], rank[view.indexOf(1)]);
+    EXPECT_GT(rank[view.indexOf(6)], rank[view.indexOf(7)]);
+    EXPECT_NEAR(rank[view.indexOf(1)], rank[view.indexOf(4)], 1e-6);
+    EXPECT_NEAR(rank[view.indexOf(5)], rank[view.indexOf(6)], 1e-6);
+
+    // Without damping every node gets the same share
+    auto uniform = graph.pageRank(0.0);
+    for (double r : uniform)
+        EXPECT_DOUBLE_EQ(r, 0.2);
+
+    EXPECT_THROW(graph.pageRank(1.5), std::invalid_argument);
+}
+
+TEST_F(NonEmptyGraph, inducedSubgraph){
+    auto sub = graph.inducedSubgraph({ 5, 6, 7, 5 });
+    ASSERT_EQ(sub.nodeCount(), 3);
+    EXPECT_THAT(sub.ids, ElementsAre(5, 6, 7));
+    EXPECT_EQ(sub.neighbors.size(), 6);
+    for (size_t idx = 0; idx < sub.nodeCount(); idx++)
+        EXPECT_EQ(sub.degree(idx), 2);
+
+    auto single = graph.inducedSubgraph({ 1 });
+    ASSERT_EQ(single.nodeCount(), 1);
+    EXPECT_EQ(single.degree(0), 0);
+
+    EXPECT_THROW(graph.inducedSubgraph({ 1, 9 }), std::out_of_range);
+}
+
+TEST_F(NonEmptyGraph, egoNetwork){
+    auto ego = graph.egoNetwork(1, 0);
+    EXPECT_THAT(ego.ids, ElementsAre(1));
+
+    ego = graph.egoNetwork(1, 1);
+    ASSERT_EQ(ego.nodeCount(), 3);
+    EXPECT_EQ(ego.ids[0], 1);
+    EXPECT_THAT(ego.ids, UnorderedElementsAre(1, 4, 5));
+    EXPECT_EQ(ego.degree(0), 2);
+    EXPECT_EQ(ego.degree(ego.indexOf(4)), 1);
+
+    ego = graph.egoNetwork(1, 2);
+    EXPECT_EQ(ego.nodeCount(), 5);
+    EXPECT_EQ(ego.neighbors.size(), 12);
+
+    EXPECT_THROW(graph.egoNetwork(9, 1), std::out_of_range);
+}
+
+TEST_F(NonEmptyGraph, copy){
+    Graph copy(graph);
+    const Graph& shared = copy;
+
+    // Read-only access does not copy the nodes
+    EXPECT_EQ(shared.getNode(1), static_cast<const Graph&>(graph).getNode(1));
+    EXPECT_EQ(&shared.csr(), &static_cast<const Graph&>(graph).csr());
+
+    // The first change detaches the copy
+    copy.removeNode(1);
+    EXPECT_EQ(copy.nodeCount(), 4);
+    EXPECT_EQ(copy.edgeCount(), 4);
+    EXPECT_EQ(graph.nodeCount(), 5);
+    EXPECT_EQ(graph.edgeCount(), 6);
+    EXPECT_NE(copy.getNode(5), graph.getNode(5));
+
+    copy.getNode(5)->color = 3;
+    EXPECT_EQ(graph.getNode(5)->color, 0);
+
+    Graph assigned;
+    assigned = graph;
+    graph.clear();
+    EXPECT_EQ(assigned.nodeCount(), 5);
+    EXPECT_THAT(assigned.edges(), UnorderedElementsAre(Eq(Edge(1, 4)), Eq(Edge(1, 5)), Eq(Edge(4, 6)), Eq(Edge(5, 6)),
+                                                       Eq(Edge(5, 7)), Eq(Edge(7, 6))));
+}
+
+TEST_F(NonEmptyGraph, move){
+    Node* node = graph.getNode(1);
+    Graph moved(std::move(graph));
+    EXPECT_EQ(moved.getNode(1), node);
+    EXPECT_EQ(moved.edgeCount(), 6);
+    EXPECT_EQ(graph.nodeCount(), 0);
+    EXPECT_EQ(graph.edgeCount(), 0);
+
+    // Moved-from graph stays usable
+    EXPECT_TRUE(graph.addEdge(Edge(1, 2)));
+    graph = std::move(moved);
+    EXPECT_EQ(graph.getNode(1), node);
+    EXPECT_EQ(graph.edgeCount(), 6);
+}
+
+TEST(LargeGraph, distances){
+    // Path 0 - 1 - ... - 149, more sources than one batch
+    Graph graph;
+    std::vector<size_t> sources;
+    for (size_t i = 0; i < 150; i++){
+        graph.addEdge(Edge(i, i + 1));
+        sources.push_back(149 - i);
+    }
+
+    auto dist = graph.distances(sources);
+    const GraphCsr& view = graph.csr();
+    for (size_t s = 0; s < sources.size(); s++){
+        for (size_t v = 0; v < view.nodeCount(); v++){
+            size_t expected = sources[s] > view.ids[v] ? sources[s] - view.ids[v] : view.ids[v] - sources[s];
+            ASSERT_EQ(dist[s][v], expected);
+        }
+    }
+}
+
 TEST_F(EmptyGraph, nodes){
     auto nodes = graph.nodes();
     EXPECT_EQ(nodes.size(), 0);
@@ -322,6 +476,20 @@ TEST_F(EmptyGraph, coloring){
     EXPECT_EQ(nodes.size(), 0);
 }
 
+TEST_F(EmptyGraph, distances){
+    EXPECT_TRUE(graph.distances({}).empty());
+    EXPECT_THROW(graph.distances({ 1 }), std::out_of_range);
+}
+
+TEST_F(EmptyGraph, pageRank){
+    EXPECT_TRUE(graph.pageRank().empty());
+
+    // Isolated nodes share the rank equally
+    graph.addNode(1);
+    graph.addNode(2);
+    EXPECT_THAT(graph.pageRank(), ElementsAre(DoubleNear(0.5, 1e-12), DoubleNear(0.5, 1e-12)));
+}
+
 TEST_F(EmptyGraph, clear){
     graph.clear();
     auto nodes = graph.nodes();
@@ -332,6 +500,87 @@ TEST_F(EmptyGraph, clear){
 }
 
 
+TEST(StreamingGraph, addEdge){
+    StreamingGraph graph(100, 10);
+    EXPECT_TRUE(graph.addEdge(Edge(1, 4), 0));
+    EXPECT_TRUE(graph.addEdge(Edge(1, 5), 5));
+    EXPECT_FALSE(graph.addEdge(Edge(4, 1), 12));
+    EXPECT_FALSE(graph.addEdge(Edge(7, 7), 12));
+
+    EXPECT_EQ(graph.nodeCount(), 3);
+    EXPECT_EQ(graph.edgeCount(), 2);
+    EXPECT_EQ(graph.nodeDegree(1), 2);
+    EXPECT_TRUE(graph.containsEdge(Edge(4, 1)));
+    EXPECT_THAT(graph.neighbors(1), UnorderedElementsAre(4, 5));
+    EXPECT_THAT(graph.edges(), UnorderedElementsAre(Eq(Edge(1, 4)), Eq(Edge(1, 5))));
+    EXPECT_THROW(graph.nodeDegree(7), std::out_of_range);
+}
+
+TEST(StreamingGraph, expire){
+    StreamingGraph graph(100, 10);
+    graph.addEdge(Edge(1, 4), 0);
+    graph.addEdge(Edge(1, 5), 5);
+    graph.addEdge(Edge(4, 1), 12);
+    graph.addEdge(Edge(5, 6), 25);
+
+    // Nothing has left the window yet
+    EXPECT_EQ(graph.expire(100), 0);
+
+    // First segment [0, 10) expires, edge {1, 4} lives on thanks to its second copy
+    EXPECT_EQ(graph.expire(109), 2);
+    EXPECT_TRUE(graph.containsEdge(Edge(1, 4)));
+    EXPECT_FALSE(graph.containsEdge(Edge(1, 5)));
+    EXPECT_EQ(graph.nodeDegree(1), 1);
+    EXPECT_EQ(graph.nodeDegree(5), 1);
+    EXPECT_EQ(graph.edgeCount(), 2);
+
+    EXPECT_EQ(graph.expire(119), 1);
+    EXPECT_FALSE(graph.containsEdge(Edge(1, 4)));
+    EXPECT_THROW(graph.nodeDegree(1), std::out_of_range);
+    EXPECT_EQ(graph.nodeCount(), 2);
+
+    EXPECT_EQ(graph.expire(1000), 1);
+    EXPECT_EQ(graph.nodeCount(), 0);
+    EXPECT_EQ(graph.edgeCount(), 0);
+    EXPECT_TRUE(graph.edges().empty());
+}
+
+TEST(StreamingGraph, expireBoundary){
+    StreamingGraph graph(100, 10);
+    graph.addEdge(Edge(1, 4), 0);
+
+    // The newest possible edge of segment [0, 10) is valid up to time 109
+    EXPECT_EQ(graph.expire(108), 0);
+    EXPECT_TRUE(graph.containsEdge(Edge(1, 4)));
+    EXPECT_EQ(graph.expire(109), 1);
+    EXPECT_FALSE(graph.containsEdge(Edge(1, 4)));
+
+    // A window reaching past the end of time never expires
+    StreamingGraph endless(UINT64_MAX, 10);
+    endless.addEdge(Edge(1, 4), 0);
+    EXPECT_EQ(endless.expire(1000), 0);
+    EXPECT_EQ(endless.expire(UINT64_MAX), 0);
+    EXPECT_TRUE(endless.containsEdge(Edge(1, 4)));
+
+    // Timestamps close to the end of time keep their segments
+    StreamingGraph late(100, 10);
+    EXPECT_TRUE(late.addEdge(Edge(1, 4), UINT64_MAX - 150));
+    EXPECT_TRUE(late.addEdge(Edge(1, 5), UINT64_MAX - 1));
+    EXPECT_EQ(late.expire(UINT64_MAX - 47), 0);
+    EXPECT_EQ(late.expire(UINT64_MAX), 1);
+    EXPECT_FALSE(late.containsEdge(Edge(1, 4)));
+    EXPECT_TRUE(late.containsEdge(Edge(1, 5)));
+}
+
+TEST(StreamingGraph, clear){
+    StreamingGraph graph(100);
+    graph.addEdge(Edge(1, 4), 0);
+    graph.clear();
+    EXPECT_EQ(graph.nodeCount(), 0);
+    EXPECT_EQ(graph.edgeCount(), 0);
+    EXPECT_EQ(graph.expire(1000), 0);
+}
+
 TEST(Edges, equal){
     EXPECT_TRUE(Edge(1, 4)==Edge(1, 4));
     EXPECT_TRUE(Edge(4, 1)==Edge(1, 4));
@@ -17,348 +17,3559 @@
 
 #include "white_box_code.h"
 #include <stdio.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/** Požadavek na načtení paměti do cache, bez podpory překladače nic nedělá. */
+#if defined(__GNUC__)
+#define HASH_MAP_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define HASH_MAP_PREFETCH(addr) ((void)(addr))
+#endif
 
 /*******************************************************************************
  * Pomocné metody.
  ******************************************************************************/
+/** Konstanty míchání hašovací funkce (liché s vyváženým počtem jedniček). */
+static const uint64_t hash_secret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull,
+    0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+};
+
 /**
- * @brief Výpočet haše pro zadaný řetězec.
+ * @brief Vynásobí dvě 64bitová čísla a uloží dolní a horní polovinu 
+ *        128bitového součinu zpět do činitelů.
+ *
+ * @param[in,out] a první činitel, dolní polovina součinu
+ * @param[in,out] b druhý činitel, horní polovina součinu
+ */
+static inline void hash_mum(uint64_t* a, uint64_t* b)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t product = (__uint128_t)*a * *b;
+    *a = (uint64_t)product;
+    *b = (uint64_t)(product >> 64);
+#else
+    uint64_t ha = *a >> 32, la = (uint32_t)*a, hb = *b >> 32, lb = (uint32_t)*b;
+    uint64_t hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    uint64_t mid = (ll >> 32) + (uint32_t)hl + (uint32_t)lh;
+    *a = (mid << 32) | (uint32_t)ll;
+    *b = hh + (hl >> 32) + (lh >> 32) + (mid >> 32);
+#endif
+}
+
+/**
+ * @brief Vynásobí dvě 64bitová čísla a vrátí xor horní a dolní poloviny 
+ *        128bitového součinu.
+ *
+ * @param[in] a první činitel
+ * @param[in] b druhý činitel
+ * @return promíchaný součin
+ */
+static inline uint64_t hash_mix(uint64_t a, uint64_t b)
+{
+    hash_mum(&a, &b);
+    return a ^ b;
+}
+
+/**
+ * @brief Načte 8 bajtů z libovolně zarovnané adresy.
+ */
+static inline uint64_t hash_read64(const uint8_t* p)
+{
+    uint64_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Načte 4 bajty z libovolně zarovnané adresy.
+ */
+static inline uint64_t hash_read32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Výpočet haše pro zadanou posloupnost bajtů.
+ *
+ * Funkce zpracovává klíč po 8 bajtech (delší klíče po 48 bajtech ve třech 
+ * nezávislých proudech) a každý krok míchá 128bitovým násobením, takže 
+ * změna libovolného bitu klíče ovlivní všechny bity výsledku. Semínko 
+ * znemožňuje předem připravit kolidující klíče (hash flooding).
  *
- * @param[in] str klíč
+ * @param[in] data klíč
+ * @param[in] len  délka klíče v bajtech
+ * @param[in] seed semínko
  * @return hash 
  */
-size_t hash_function(const char* str)
+uint64_t hash_bytes(const void* data, size_t len, uint64_t seed)
 {
-    size_t hash = 0;
+    const uint8_t* p = (const uint8_t*)data;
+    uint64_t a, b;
 
-    for (size_t idx = 0; str[idx] != '\0'; idx++)
+    seed ^= hash_mix(seed ^ hash_secret[0], hash_secret[1]);
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            // prekryvajici se ctverice bajtu pokryji cely klic
+            size_t shift = (len >> 3) << 2;
+            a = (hash_read32(p) << 32) | hash_read32(p + shift);
+            b = (hash_read32(p + len - 4) << 32) | hash_read32(p + len - 4 - shift);
+        }
+        else if (len > 0)
+        {
+            a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        }
+        else
+        {
+            a = b = 0;
+        }
+    }
+    else
     {
-        hash += HASH_FUNCTION_PARAM_A*str[idx] + HASH_FUNCTION_PARAM_B;
+        size_t rest = len;
+        if (rest > 48)
+        {
+            // tri nezavisle proudy pro vyuziti paralelismu procesoru
+            uint64_t see1 = seed, see2 = seed;
+            do
+            {
+                seed = hash_mix(hash_read64(p) ^ hash_secret[1], hash_read64(p + 8) ^ seed);
+                see1 = hash_mix(hash_read64(p + 16) ^ hash_secret[2], hash_read64(p + 24) ^ see1);
+                see2 = hash_mix(hash_read64(p + 32) ^ hash_secret[3], hash_read64(p + 40) ^ see2);
+                p += 48;
+                rest -= 48;
+            } while (rest > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (rest > 16)
+        {
+            seed = hash_mix(hash_read64(p) ^ hash_secret[1], hash_read64(p + 8) ^ seed);
+            p += 16;
+            rest -= 16;
+        }
+        // poslednich 16 bajtu (muze se prekryvat se zpracovanymi)
+        a = hash_read64(p + rest - 16);
+        b = hash_read64(p + rest - 8);
     }
 
-    return hash;
+    a ^= hash_secret[1];
+    b ^= seed;
+    hash_mum(&a, &b);
+    return hash_mix(a ^ hash_secret[0] ^ len, b ^ hash_secret[1]);
 }
 
 /**
- * @brief Výpočet indexu v hašovací tabulce v závislosti na dvojici klíč-hash.
- * 
- * V případě kolize funkce nalezne další volný index v tabulce. V případě 
- * vyhledávání považujeme @c dummy objekt jako jakýkoliv jiný záznam, tedy
- * @p ignore_dummy je nastaveno na @c false . Při vkládání je @c dummy objekt 
- * ekvivalentní prázdnému místu, tedy @p ignore_dummy je nastaveno na @c true .
- * Tento jev je způsoben kvůli kolizím klíčů. Když je záznam odstraněn, je 
- * nahrazen za @c dummy objekt, aby bylo možné vyřešit případné kolize.
- *
- * @param[in] self         Ukazatel na strukturu hašovací tabulky.
- * @param[in] str          Klíč.
- * @param[in] str          Haš zadaného klíče.
- * @param[in] ignore_dummy Pokud @c true, @c dummy objekt je vždy přeskočen,
- *                         pokud @c false, @c dummy objekt je interpretován jako
- *                         @c NULL.
- * 
- * @return Index záznamu asociovaný k zadanému klíči a haši, nebo prázdné místo
- *         v tabulce.
+ * @brief Výpočet haše pro zadaný řetězec.
+ *
+ * @param[in] str  klíč
+ * @param[in] seed semínko
+ * @return hash 
+ *
+ * @see hash_bytes
+ */
+size_t hash_function(const char* str, uint64_t seed)
+{
+    return (size_t)hash_bytes(str, strlen(str), seed);
+}
+
+/**
+ * @brief Hlavička bloku paměti slabu.
+ */
+typedef struct hash_map_chunk
+{
+    struct hash_map_chunk* next;    ///< Následující blok
+    size_t size;                    ///< Velikost bloku včetně hlavičky
+} hash_map_chunk_t;
+
+/**
+ * @brief Výchozí alokace pomocí @c malloc .
+ */
+static void* hash_map_default_alloc(void* ctx, size_t size)
+{
+    (void)ctx;
+    return malloc(size);
+}
+
+/**
+ * @brief Výchozí uvolnění pomocí @c free .
+ */
+static void hash_map_default_release(void* ctx, void* ptr, size_t size)
+{
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+/** Výchozí alokátor hašovací tabulky. */
+static const hash_map_allocator_t hash_map_default_allocator = {
+    hash_map_default_alloc, hash_map_default_release, NULL
+};
+
+/**
+ * @brief Alokace paměti alokátorem tabulky.
  */
-size_t hash_map_lookup_handle(hash_map_t* self, const char* key, size_t hash, 
-                              bool ignore_dummy)
+static inline void* hash_map_alloc(hash_map_t* self, size_t size)
 {
-    size_t idx = hash % self->allocated;
-    size_t perturb = hash;
+    return self->allocator.alloc(self->allocator.ctx, size);
+}
 
-    while ( 
-        (self->index[idx] != NULL && 
-        (ignore_dummy || self->index[idx] != self->dummy)) &&
-        (
-            self->index[idx] == self->dummy ||
-            (
-                (self->index[idx]->hash != hash) || 
-                (strcmp(self->index[idx]->key, key) != 0)
-            )
-        )
-    )
+/**
+ * @brief Uvolnění paměti alokátorem tabulky.
+ */
+static inline void hash_map_release(hash_map_t* self, void* ptr, size_t size)
+{
+    if (ptr != NULL)
     {
-        idx = ((idx << 2) + idx + perturb + 1) % self->allocated;
-        perturb >>= HASH_MAP_PERTURB_SHIFT;
+        self->allocator.release(self->allocator.ctx, ptr, size);
     }
+}
 
-    return idx;
+/**
+ * @brief Posun hodnoty pevné velikosti od začátku bloku klíče.
+ *
+ * @param[in] len Délka klíče v bajtech (bez ukončovací nuly).
+ * @return Posun za ukončovací nulu klíče zarovnaný na 8 bajtů.
+ */
+static inline size_t hash_map_value_offset(size_t len)
+{
+    return (len + 1 + 7) & ~(size_t)7;
 }
+
 /**
- * @brief Výpočet indexu v hašovací tabulce v závislosti na dvojici klíč-hash.
+ * @brief Velikost bloku klíče o dané délce.
+ *
+ * Tabulka s hodnotami pevné velikosti ukládá hodnotu do stejného bloku za
+ * klíč.
  *
  * @param[in] self Ukazatel na strukturu hašovací tabulky.
- * @param[in] str  Klíč.
- * @param[in] str  Haš zadaného klíče.
- * 
- * @return Index záznamu asociovaný k zadanému klíči a haši, nebo prázdné místo
- *         v tabulce.
- * 
- * @see hash_map_lookup_handle
+ * @param[in] len  Délka klíče v bajtech (bez ukončovací nuly).
+ * @return Velikost bloku zarovnaná na @c HASH_MAP_SLAB_ALIGN .
  */
-size_t hash_map_lookup(hash_map_t* self, const char* key, size_t hash)
+static inline size_t hash_map_key_size(const hash_map_t* self, size_t len)
 {
-    return hash_map_lookup_handle(self, key, hash, true);
+    size_t size = self->value_size != 0 ? hash_map_value_offset(len) + self->value_size : len + 1;
+    return (size + HASH_MAP_SLAB_ALIGN - 1) & ~(size_t)(HASH_MAP_SLAB_ALIGN - 1);
 }
 
 /**
- * @brief Inicializace hašovací tabulky.
- * 
- * Metoda alokuje a inicializuje položky struktury hašovací tabulky.
+ * @brief Inicializace prázdného slabu.
+ */
+static void hash_map_slab_init(hash_map_slab_t* slab)
+{
+    slab->chunks = NULL;
+    slab->cursor = NULL;
+    slab->remaining = 0;
+    slab->large = 0;
+    slab->used_bytes = 0;
+    for (size_t i = 0; i < HASH_MAP_SLAB_CLASSES; ++i)
+    {
+        slab->free_lists[i] = NULL;
+    }
+}
+
+/**
+ * @brief Přidělení bloku pro klíč ze slabu.
  * 
- * @param self[in] Ukazatel na neinicializovanou hašovací tabulku
- * @param size[in] Počet prvků v tabulce.
+ * Blok se vezme ze seznamu volných bloků velikostní třídy, jinak se odřízne 
+ * z aktuálního bloku paměti. Velké klíče se alokují přímo.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] size Velikost bloku (viz @c hash_map_key_size ).
  * 
- * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ * @return Ukazatel na blok nebo @c NULL při chybě alokace.
  */
-hash_map_state_code_t hash_map_init(hash_map_t* self, size_t size)
+static void* hash_map_slab_alloc(hash_map_t* self, size_t size)
 {
-    self->dummy = (hash_map_item_t*)malloc(sizeof(hash_map_item_t));
-    self->first = self->last = NULL;
-    self->used = 0;
-    self->allocated = 0;
-    self->index = NULL;
-    
-    if (hash_map_reserve(self, size) == MEMORY_ERROR)
+    hash_map_slab_t* slab = &self->slab;
+    if (size > HASH_MAP_SLAB_MAX_BLOCK)
     {
-        free(self->dummy);
-        return MEMORY_ERROR;
+        void* block = hash_map_alloc(self, size);
+        if (block != NULL)
+        {
+            slab->large++;
+            slab->used_bytes += size;
+        }
+        return block;
     }
 
-    return OK;
-}
-
-/*******************************************************************************
- * Definice veřejných metod.
- ******************************************************************************/
+    // recyklace uvolneneho bloku
+    size_t cls = size / HASH_MAP_SLAB_ALIGN - 1;
+    if (slab->free_lists[cls] != NULL)
+    {
+        void* block = slab->free_lists[cls];
+        slab->free_lists[cls] = *(void**)block;
+        slab->used_bytes += size;
+        return block;
+    }
 
-hash_map_t* hash_map_ctor()
-{
-    hash_map_t* map = (hash_map_t*)malloc(sizeof(hash_map_t));
-    if (map != NULL && hash_map_init(map, HASH_MAP_INIT_SIZE) == MEMORY_ERROR) 
+    if (slab->remaining < size)
     {
-        free(map);
-        map = NULL;
+        // novy blok pameti, kazdy dalsi je dvakrat vetsi
+        size_t chunk_size = slab->chunks ? slab->chunks->size << 1 : HASH_MAP_SLAB_MIN_CHUNK;
+        if (chunk_size > HASH_MAP_SLAB_MAX_CHUNK)
+        {
+            chunk_size = HASH_MAP_SLAB_MAX_CHUNK;
+        }
+        hash_map_chunk_t* chunk = (hash_map_chunk_t*)hash_map_alloc(self, chunk_size);
+        if (chunk == NULL)
+        {
+            // alokace pameti selhala
+            return NULL;
+        }
+        chunk->next = slab->chunks;
+        chunk->size = chunk_size;
+        slab->chunks = chunk;
+        slab->cursor = (char*)chunk + HASH_MAP_SLAB_ALIGN;
+        slab->remaining = chunk_size - HASH_MAP_SLAB_ALIGN;
     }
-    return map;
+
+    void* block = slab->cursor;
+    slab->cursor += size;
+    slab->remaining -= size;
+    slab->used_bytes += size;
+    return block;
 }
 
-void hash_map_clear(hash_map_t* self)
+/**
+ * @brief Vrácení bloku klíče do slabu.
+ *
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] block Blok přidělený funkcí @c hash_map_slab_alloc .
+ * @param[in] size  Velikost bloku.
+ */
+static void hash_map_slab_free(hash_map_t* self, void* block, size_t size)
 {
-    size_t idx;
-    hash_map_item_t* item = self->first;
-    hash_map_item_t* curr_item;
-    while (item != NULL)
+    hash_map_slab_t* slab = &self->slab;
+    slab->used_bytes -= size;
+    if (size > HASH_MAP_SLAB_MAX_BLOCK)
     {
-        curr_item = item;
-        item = item->next;
-        free(curr_item->key);
-        free(curr_item);
+        hash_map_release(self, block, size);
+        slab->large--;
+        return;
     }
 
-    for (size_t i = 0; i < self->allocated; ++i)
+    size_t cls = size / HASH_MAP_SLAB_ALIGN - 1;
+    *(void**)block = slab->free_lists[cls];
+    slab->free_lists[cls] = block;
+}
+
+/**
+ * @brief Uvolnění všech bloků paměti slabu najednou.
+ * 
+ * Velké klíče alokované mimo slab musí být uvolněny předem.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ */
+static void hash_map_slab_release(hash_map_t* self)
+{
+    hash_map_chunk_t* chunk = self->slab.chunks;
+    while (chunk != NULL)
     {
-        self->index[i] = NULL;
+        hash_map_chunk_t* next = chunk->next;
+        hash_map_release(self, chunk, chunk->size);
+        chunk = next;
     }
-    
+    hash_map_slab_init(&self->slab);
+}
 
-    self->first = NULL;
-    self->last = NULL;
-    self->used = 0;
+/**
+ * @brief Sedmibitový otisk haše uložený v řídicím bajtu obsazeného místa.
+ */
+static inline uint8_t hash_map_h2(size_t hash)
+{
+    return (uint8_t)(hash & 0x7f);
 }
 
-void hash_map_dtor(hash_map_t* self)
+/**
+ * @brief Počet skupin řídicích bajtů pro index o zadané velikosti.
+ */
+static inline size_t hash_map_groups(size_t size)
 {
-    hash_map_clear(self);
-    free(self->index);
-    free(self->dummy);
-    self->index = NULL;
-    self->allocated = 0;
-    free(self);
+    return (size + HASH_MAP_GROUP_WIDTH - 1) / HASH_MAP_GROUP_WIDTH;
 }
 
-hash_map_state_code_t hash_map_reserve(hash_map_t* self, size_t size)
+/**
+ * @brief Bitová maska míst skupiny, jejichž řídicí bajt je roven @p value .
+ *
+ * @param[in] group První řídicí bajt skupiny.
+ * @param[in] value Hledaná hodnota.
+ * 
+ * @return Maska, bit @c i odpovídá @c i -tému místu skupiny.
+ */
+static inline uint32_t hash_map_group_match(const uint8_t* group, uint8_t value)
 {
-    // chceme alokovat mene mista nez je vlozenych zaznamu?
-    if (size < self->used)
+#if defined(__SSE2__)
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)value)));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < HASH_MAP_GROUP_WIDTH; ++i)
     {
-        return VALUE_ERROR;
+        mask |= (uint32_t)(group[i] == value) << i;
     }
+    return mask;
+#endif
+}
 
-    if (size == self->allocated)
+/**
+ * @brief Bitová maska prázdných nebo odstraněných míst skupiny.
+ *
+ * @param[in] group První řídicí bajt skupiny.
+ * 
+ * @return Maska, bit @c i odpovídá @c i -tému místu skupiny.
+ */
+static inline uint32_t hash_map_group_match_free(const uint8_t* group)
+{
+#if defined(__SSE2__)
+    // prazdne (-128) a odstranene (-2) misto jsou jako jedine mensi nez -1
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+#else
+    uint32_t mask = 0;
+    for (size_t i = 0; i < HASH_MAP_GROUP_WIDTH; ++i)
     {
-        // jiz je alokovano
-        return OK;
+        mask |= (uint32_t)(group[i] == HASH_MAP_CTRL_EMPTY || 
+                           group[i] == HASH_MAP_CTRL_DELETED) << i;
     }
+    return mask;
+#endif
+}
 
-    hash_map_item_t** new_index = (hash_map_item_t**)malloc(size*sizeof(hash_map_t*));
-    if (new_index == NULL)
+/**
+ * @brief Šířka (v bajtech) offsetu do pole záznamů.
+ *
+ * Index obsahuje jen offsety do pole záznamů, stačí jim tedy nejmenší šířka,
+ * do které se vejde největší offset. Malé tabulky tak mají index
+ * s jednobajtovými místy.
+ *
+ * @param[in] entries Kapacita pole záznamů.
+ *
+ * @return 1, 2, 4 nebo 8 bajtů.
+ */
+static inline uint8_t hash_map_offset_width(size_t entries)
+{
+    if (entries <= ((size_t)1 << 8))
     {
-        // alokace pameti selhala
-        return MEMORY_ERROR;
+        return 1;
     }
-    // vycisteni indexu
-    for (size_t i = 0; i < size; ++i)
+    if (entries <= ((size_t)1 << 16))
     {
-        new_index[i] = NULL;
+        return 2;
     }
-
-    if (self->index != NULL)
+    if (entries <= ((size_t)1 << 31 << 1))
     {
-        // prekopirovani indexu
-        size_t idx;
-        for (hash_map_item_t* item = self->first; item != NULL; item = item->next)
-        {
-            // zmenila se velikost, potrebujeme prepocitat indexy
-            idx = hash_map_lookup(self, item->key, item->hash);
-            new_index[idx] = item;
-        }
-        // uvolneni stareho indexu
-        free(self->index);
+        return 4;
     }
-    // nahrazeni stareho indexu
-    self->index = new_index;
-    self->allocated = size;
+    return 8;
+}
 
-    return OK; 
+/**
+ * @brief Offset záznamu uložený na místě indexu.
+ *
+ * @param[in] index Index tabulky.
+ * @param[in] width Šířka offsetu v bajtech.
+ * @param[in] idx   Místo v indexu.
+ *
+ * @return Offset záznamu v poli záznamů.
+ */
+static inline size_t hash_map_offset_get(const void* index, uint8_t width, size_t idx)
+{
+    switch (width)
+    {
+        case 1:
+            return ((const uint8_t*)index)[idx];
+        case 2:
+            return ((const uint16_t*)index)[idx];
+        case 4:
+            return ((const uint32_t*)index)[idx];
+        default:
+            return (size_t)((const uint64_t*)index)[idx];
+    }
 }
 
-size_t hash_map_size(hash_map_t* self) 
+/**
+ * @brief Uložení offsetu záznamu na místo indexu.
+ *
+ * @param[in] index  Index tabulky.
+ * @param[in] width  Šířka offsetu v bajtech.
+ * @param[in] idx    Místo v indexu.
+ * @param[in] offset Offset záznamu v poli záznamů.
+ */
+static inline void hash_map_offset_set(void* index, uint8_t width, size_t idx, size_t offset)
 {
-    return self->used;
+    switch (width)
+    {
+        case 1:
+            ((uint8_t*)index)[idx] = (uint8_t)offset;
+            break;
+        case 2:
+            ((uint16_t*)index)[idx] = (uint16_t)offset;
+            break;
+        case 4:
+            ((uint32_t*)index)[idx] = (uint32_t)offset;
+            break;
+        default:
+            ((uint64_t*)index)[idx] = (uint64_t)offset;
+            break;
+    }
 }
 
-size_t hash_map_capacity(hash_map_t* self)
+/**
+ * @brief Kapacita pole záznamů pro index o zadané velikosti.
+ *
+ * Index se zvětšuje při zaplnění @c HASH_MAP_REALLOCATION_THRESHOLD , více
+ * záznamů se do něj tedy nikdy nevloží.
+ *
+ * @param[in] size Velikost indexu.
+ * @param[in] used Počet záznamů, které se musí do pole vejít.
+ *
+ * @return Kapacita pole záznamů.
+ */
+static inline size_t hash_map_entries_capacity(size_t size, size_t used)
 {
-    return self->allocated;
+    size_t capacity = (size_t)(size * HASH_MAP_REALLOCATION_THRESHOLD) + 1;
+    if (capacity > size)
+    {
+        capacity = size;
+    }
+    return capacity < used ? used : capacity;
 }
 
-bool hash_map_contains(hash_map_t* self, const char* key)
+/**
+ * @brief Započtení délky hledání do histogramu tabulky.
+ *
+ * Každé hledání klíče se započte jednou, během postupné realokace se délky 
+ * hledání v obou indexech sečtou. Hledání v prázdném indexu se nepočítá.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] found  Byl klíč nalezen?
+ * @param[in] length Počet prošlých skupin (míst u metody Robin Hood).
+ */
+static inline void hash_map_count_probe(hash_map_t* self, bool found, size_t length)
 {
-    size_t hash = hash_function(key); 
-    size_t idx = hash_map_lookup(self, key, hash);
-    return self->index[idx] != NULL;
+#if HASH_MAP_STATS
+    if (self->count_probes && length > 0)
+    {
+        size_t* histogram = found ? self->counters.probe_hits : self->counters.probe_misses;
+        histogram[(length < HASH_MAP_STATS_PROBES ? length : HASH_MAP_STATS_PROBES) - 1]++;
+    }
+#else
+    (void)self;
+    (void)found;
+    (void)length;
+#endif
 }
 
-hash_map_state_code_t hash_map_put(hash_map_t* self, const char* key, int value)
+/**
+ * @brief Porovnání hledaného klíče s klíčem na místě indexu.
+ *
+ * @param[in] ctx Kontext hledání (klíč a tabulka, do které index patří).
+ * @param[in] idx Místo indexu se shodným otiskem haše.
+ *
+ * @return Je na místě hledaný klíč?
+ */
+typedef bool (*hash_map_ctrl_match_t)(const void* ctx, size_t idx);
+
+/**
+ * @brief Hledání haše ve skupinách řídicích bajtů.
+ *
+ * Společné hledání tabulky s řetězcovými i s celočíselnými klíči. Prochází
+ * skupiny od skupiny určené hašem, porovná všechny řídicí bajty skupiny
+ * najednou (SSE2) a funkci @p match volá jen u míst se shodným otiskem haše.
+ * Hledání končí ve skupině, která obsahuje prázdné místo, protože dál by klíč
+ * nebyl nikdy vložen.
+ *
+ * Odstraněné místo se při hledání přeskakuje, při vkládání je ekvivalentní
+ * prázdnému místu. Proto funkce vrací také první volné místo na cestě.
+ *
+ * @param[in]  ctrl_bytes Řídicí bajty prohledávaného indexu.
+ * @param[in]  allocated  Velikost prohledávaného indexu.
+ * @param[in]  hash       Haš hledaného klíče.
+ * @param[in]  match      Porovnání klíče na místě indexu.
+ * @param[in]  ctx        Kontext funkce @p match .
+ * @param[out] found      Nastaveno na @c true , pokud byl klíč nalezen.
+ * @param[out] length     Počet prošlých skupin, u prázdného indexu 0.
+ *
+ * @return Místo klíče, nebo první volné místo na cestě. Pokud klíč chybí
+ *         a index nemá volné místo, vrací @c HASH_MAP_NOT_FOUND .
+ */
+static inline size_t hash_map_ctrl_probe(const uint8_t* ctrl_bytes, size_t allocated,
+                                         size_t hash, hash_map_ctrl_match_t match,
+                                         const void* ctx, bool* found, size_t* length)
 {
-    // je potreba realokovat misto?
-    if (((float)self->used / (float)self->allocated) >= HASH_MAP_REALLOCATION_THRESHOLD)
+    *found = false;
+    *length = 0;
+    if (allocated == 0)
     {
-        hash_map_reserve(self, self->allocated<<1);
+        return HASH_MAP_NOT_FOUND;
     }
 
-    size_t hash = hash_function(key);
-    size_t idx = hash_map_lookup_handle(self, key, hash, false);
+    size_t groups = hash_map_groups(allocated);
+    size_t group = (hash >> 7) % groups;
+    size_t free_idx = HASH_MAP_NOT_FOUND;
+    uint8_t h2 = hash_map_h2(hash);
 
-    // prazdne misto v indexu nebo se jedna o dummy objekt
-    // Vizte hash_map_lookup_handle
-    if (self->index[idx] == NULL || self->index[idx] == self->dummy) 
+    size_t probe = 0;
+    for (; probe < groups; ++probe)
     {
-        self->index[idx] = (hash_map_item_t*)malloc(sizeof(hash_map_item_t));
-        if (self->index[idx] == NULL)
-        {
-            // alokace pameti selhala
-            return MEMORY_ERROR;
-        }
+        const uint8_t* ctrl = ctrl_bytes + group*HASH_MAP_GROUP_WIDTH;
 
-        self->index[idx]->key = (char*)malloc((strlen(key)+1)*sizeof(char));
-        if (self->index[idx]->key == NULL)
+        // kandidati se shodnym otiskem hase
+        for (uint32_t mask = hash_map_group_match(ctrl, h2); mask != 0; mask &= mask - 1)
         {
-            // alokace pameti selhala
-            free(self->index[idx]);
-            self->index[idx] = NULL;
-            return MEMORY_ERROR;
+            size_t idx = group*HASH_MAP_GROUP_WIDTH + __builtin_ctz(mask);
+            if (match(ctx, idx))
+            {
+                *found = true;
+                *length = probe + 1;
+                return idx;
+            }
         }
-        strcpy(self->index[idx]->key, key);
-        self->index[idx]->hash = hash;
-        self->index[idx]->value = value;
-        self->index[idx]->next = NULL;
-        self->index[idx]->prev = NULL;
-        self->used++;
-        // je seznam zaznamu prazdny?
-        if (self->last == NULL)
+
+        // zapamatovani prvniho volneho mista pro vlozeni
+        uint32_t free_mask = hash_map_group_match_free(ctrl);
+        if (free_idx == HASH_MAP_NOT_FOUND && free_mask != 0)
         {
-            self->first = self->last = self->index[idx];
+            free_idx = group*HASH_MAP_GROUP_WIDTH + __builtin_ctz(free_mask);
         }
-        else
+
+        // prazdne misto ukoncuje retezec kolizi
+        if (hash_map_group_match(ctrl, HASH_MAP_CTRL_EMPTY) != 0)
         {
-            self->last->next = self->index[idx];
-            self->index[idx]->prev = self->last;
-            self->last = self->index[idx];
+            break;
         }
-        return OK;
-    }
-    else 
-    {
-        self->index[idx]->value = value;
-        return KEY_ALREADY_EXISTS;
+
+        group = (group + 1) % groups;
     }
+
+    *length = probe < groups ? probe + 1 : groups;
+    return free_idx;
 }
 
-hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key, int* dst)
+/**
+ * @brief První volné místo na cestě hledání haše.
+ *
+ * Při přestavbě indexu jsou klíče jistě unikátní, stačí tedy najít první
+ * volné místo na cestě hledání určené hašem. Klíče se přitom nečtou,
+ * prochází se jen řídicí bajty.
+ *
+ * @param[in] ctrl_bytes Řídicí bajty indexu, který má volné místo.
+ * @param[in] allocated  Velikost indexu.
+ * @param[in] hash       Haš vkládaného klíče.
+ *
+ * @return Volné místo indexu.
+ */
+static inline size_t hash_map_ctrl_free_slot(const uint8_t* ctrl_bytes, size_t allocated,
+                                             size_t hash)
 {
-    size_t hash = hash_function(key);
-    size_t idx = hash_map_lookup(self, key, hash);
+    size_t groups = hash_map_groups(allocated);
+    size_t group = (hash >> 7) % groups;
+    uint32_t free_mask;
 
-    if (self->index[idx] == NULL)
+    while ((free_mask = hash_map_group_match_free(ctrl_bytes + group*HASH_MAP_GROUP_WIDTH)) == 0)
     {
-        // klic neni asociovan se zadnym zaznamem
-        return KEY_ERROR;
+        group = (group + 1) % groups;
     }
-    
-    *dst = self->index[idx]->value;
-
-    return OK;
+    return group*HASH_MAP_GROUP_WIDTH + __builtin_ctz(free_mask);
 }
 
-hash_map_state_code_t hash_map_remove(hash_map_t* self, const char* key)
+/**
+ * @brief Obsazení volného místa indexu hašem vkládaného klíče.
+ *
+ * @param[in] ctrl Řídicí bajty indexu.
+ * @param[in] idx  Volné místo indexu.
+ * @param[in] hash Haš vkládaného klíče.
+ *
+ * @return @c true , pokud bylo místo odstraněné.
+ */
+static inline bool hash_map_ctrl_fill(uint8_t* ctrl, size_t idx, size_t hash)
 {
-    int dst;
-    return hash_map_pop(self, key, &dst);
+    bool deleted = ctrl[idx] == HASH_MAP_CTRL_DELETED;
+    ctrl[idx] = hash_map_h2(hash);
+    return deleted;
 }
 
-hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key, int* dst)
-{
-    size_t hash = hash_function(key);
-    size_t idx = hash_map_lookup(self, key, hash);
+/**
+ * @brief Uvolnění místa indexu.
+ *
+ * V případě kolize, odstranění prvně vloženého záznamu s kolizí a označení
+ * daného místa jako prázdného by hledání nemělo informaci, zda ke kolizi
+ * došlo. Pokud ale skupina obsahuje prázdné místo, žádné hledání skupinou
+ * neprošlo dál a místo může být prázdné.
+ *
+ * @param[in] ctrl Řídicí bajty indexu.
+ * @param[in] idx  Uvolňované místo.
+ *
+ * @return @c true , pokud bylo místo označeno jako odstraněné.
+ */
+static inline bool hash_map_ctrl_erase(uint8_t* ctrl, size_t idx)
+{
+    if (hash_map_group_match(ctrl + idx / HASH_MAP_GROUP_WIDTH * HASH_MAP_GROUP_WIDTH,
+                             HASH_MAP_CTRL_EMPTY) != 0)
+    {
+        ctrl[idx] = HASH_MAP_CTRL_EMPTY;
+        return false;
+    }
+    ctrl[idx] = HASH_MAP_CTRL_DELETED;
+    return true;
+}
+
+/**
+ * @brief Nastavení řídicích bajtů prázdného indexu.
+ *
+ * Místa za koncem indexu (do celé skupiny) nejsou nikdy volná.
+ *
+ * @param[in] ctrl      Řídicí bajty zarovnané na celé skupiny.
+ * @param[in] allocated Velikost indexu.
+ */
+static inline void hash_map_ctrl_init(uint8_t* ctrl, size_t allocated)
+{
+    memset(ctrl, HASH_MAP_CTRL_EMPTY, allocated);
+    memset(ctrl + allocated, HASH_MAP_CTRL_SENTINEL,
+           hash_map_groups(allocated)*HASH_MAP_GROUP_WIDTH - allocated);
+}
+
+/**
+ * @brief Potřebuje index před vložením přestavbu?
+ *
+ * Odstraněná místa prodlužují hledání stejně jako živé záznamy.
+ *
+ * @param[in] used      Počet živých záznamů.
+ * @param[in] deleted   Počet odstraněných míst.
+ * @param[in] allocated Velikost neprázdného indexu.
+ *
+ * @return Dosáhlo zaplnění @c HASH_MAP_REALLOCATION_THRESHOLD ?
+ */
+static inline bool hash_map_needs_resize(size_t used, size_t deleted, size_t allocated)
+{
+    return ((float)(used + deleted) / (float)allocated) >= HASH_MAP_REALLOCATION_THRESHOLD;
+}
+
+/**
+ * @brief Velikost indexu po přestavbě při vkládání.
+ *
+ * @param[in] used      Počet živých záznamů.
+ * @param[in] allocated Velikost indexu.
+ *
+ * @return Dvojnásobná velikost, při malém počtu živých záznamů stačí uklidit
+ *         odstraněná místa a velikost zůstane.
+ */
+static inline size_t hash_map_grow_size(size_t used, size_t allocated)
+{
+    if (((float)used / (float)allocated) < HASH_MAP_REALLOCATION_THRESHOLD / 2)
+    {
+        return allocated;
+    }
+    return allocated<<1;
+}
+
+/**
+ * @brief Velikost indexu po odstranění záznamu.
+ *
+ * @param[in] used      Počet živých záznamů.
+ * @param[in] allocated Velikost indexu.
+ * @param[in] reserved  Rezervovaná velikost, pod kterou se index nezmenší.
+ *
+ * @return Poloviční velikost (nejméně @p reserved ) při zaplnění pod
+ *         @c HASH_MAP_SHRINK_THRESHOLD , jinak @p allocated .
+ */
+static inline size_t hash_map_shrink_size(size_t used, size_t allocated, size_t reserved)
+{
+    if (allocated <= reserved || ((float)used / (float)allocated) >= HASH_MAP_SHRINK_THRESHOLD)
+    {
+        return allocated;
+    }
+    size_t size = allocated >> 1;
+    return size > reserved ? size : reserved;
+}
+
+/**
+ * @brief Kontext porovnání klíče se záznamem, na který ukazuje index.
+ */
+typedef struct hash_map_item_match
+{
+    const void* index;              ///< Prohledávaný index
+    uint8_t width;                  ///< Šířka offsetů indexu
+    const hash_map_item_t* entries; ///< Pole záznamů, do kterého index ukazuje
+    const void* key;                ///< Hledaný klíč
+    size_t len;                     ///< Délka klíče v bajtech
+    size_t hash;                    ///< Haš klíče
+} hash_map_item_match_t;
+
+/**
+ * @brief Porovnání klíče se záznamem (viz @c hash_map_ctrl_match_t ).
+ */
+static inline bool hash_map_item_match(const void* ctx, size_t idx)
+{
+    const hash_map_item_match_t* match = (const hash_map_item_match_t*)ctx;
+    const hash_map_item_t* item = match->entries +
+                                  hash_map_offset_get(match->index, match->width, idx);
+    // delky se porovnaji pred obsahem klicu
+    return item->hash == match->hash && item->key_len == match->len &&
+           memcmp(item->key, match->key, match->len) == 0;
+}
+
+/**
+ * @brief Výpočet indexu v hašovací tabulce v závislosti na dvojici klíč-hash.
+ *
+ * Index je rozdělen do skupin po @c HASH_MAP_GROUP_WIDTH místech. Ke každému
+ * místu patří řídicí bajt, který je buď prázdný, odstraněný, nebo obsahuje
+ * sedm bitů haše vloženého záznamu. Záznam se dereferencuje jen u míst se
+ * shodným otiskem haše (viz @c hash_map_ctrl_probe ).
+ *
+ * @param[in]  index      Index prohledávané tabulky.
+ * @param[in]  width      Šířka offsetů prohledávaného indexu.
+ * @param[in]  ctrl_bytes Řídicí bajty prohledávané tabulky.
+ * @param[in]  allocated  Velikost prohledávaného indexu.
+ * @param[in]  entries    Pole záznamů, do kterého index ukazuje.
+ * @param[in]  key        Klíč.
+ * @param[in]  len        Délka klíče v bajtech.
+ * @param[in]  hash       Haš zadaného klíče.
+ * @param[out] found      Nastaveno na @c true , pokud byl klíč nalezen.
+ * @param[out] length     Počet prošlých skupin (viz @c hash_map_count_probe ).
+ *
+ * @return Index záznamu asociovaný k zadanému klíči a haši, nebo první volné
+ *         místo v tabulce. Pokud klíč chybí a tabulka nemá volné místo, vrací
+ *         @c HASH_MAP_NOT_FOUND .
+ */
+static inline size_t hash_map_probe(const void* index, uint8_t width,
+                                    const uint8_t* ctrl_bytes, size_t allocated,
+                                    const hash_map_item_t* entries, const void* key,
+                                    size_t len, size_t hash, bool* found, size_t* length)
+{
+    hash_map_item_match_t match = { index, width, entries, key, len, hash };
+    return hash_map_ctrl_probe(ctrl_bytes, allocated, hash, hash_map_item_match, &match,
+                               found, length);
+}
+
+/**
+ * @brief Domovské místo haše v indexu prohledávaném metodou Robin Hood.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash Haš klíče.
+ *
+ * @return Místo indexu, od kterého začíná hledání.
+ */
+static inline size_t hash_map_robin_hood_home(const hash_map_t* self, size_t hash)
+{
+    return (hash >> 7) % self->allocated;
+}
+
+/**
+ * @brief Vzdálenost záznamu na místě indexu od jeho domovského místa.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] idx  Obsazené místo indexu.
+ *
+ * @return Počet míst, o která je záznam posunut.
+ */
+static inline size_t hash_map_robin_hood_distance(const hash_map_t* self, size_t idx)
+{
+    size_t offset = hash_map_offset_get(self->index, self->index_width, idx);
+    size_t home = hash_map_robin_hood_home(self, self->entries[offset].hash);
+    return (idx + self->allocated - home) % self->allocated;
+}
+
+/**
+ * @brief Hledání klíče v indexu prohledávaném metodou Robin Hood.
+ *
+ * Místa se prochází lineárně od domovského místa. Záznam se dereferencuje jen
+ * u míst se shodným otiskem haše. Hledání končí na prázdném místě nebo po
+ * @c max_probe místech, dál žádný záznam posunut není.
+ *
+ * @param[in]  self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key    Klíč.
+ * @param[in]  len    Délka klíče v bajtech.
+ * @param[in]  hash   Haš zadaného klíče.
+ * @param[out] found  Nastaveno na @c true , pokud byl klíč nalezen.
+ * @param[out] length Počet prošlých míst (viz @c hash_map_count_probe ).
+ *
+ * @return Index záznamu, nebo @c HASH_MAP_NOT_FOUND . Místo pro vložení
+ *         určuje až @c hash_map_robin_hood_place .
+ */
+static size_t hash_map_robin_hood_probe(const hash_map_t* self, const void* key, size_t len,
+                                        size_t hash, bool* found, size_t* length)
+{
+    *found = false;
+    *length = 0;
+    if (self->allocated == 0)
+    {
+        return HASH_MAP_NOT_FOUND;
+    }
+
+    size_t idx = hash_map_robin_hood_home(self, hash);
+    uint8_t h2 = hash_map_h2(hash);
+    size_t distance = 0;
+    for (; distance <= self->max_probe; ++distance)
+    {
+        if (self->ctrl[idx] == HASH_MAP_CTRL_EMPTY)
+        {
+            break;
+        }
+        if (self->ctrl[idx] == h2)
+        {
+            hash_map_item_t* item = self->entries + hash_map_offset_get(self->index, self->index_width, idx);
+            if (item->hash == hash && item->key_len == len && memcmp(item->key, key, len) == 0)
+            {
+                *found = true;
+                *length = distance + 1;
+                return idx;
+            }
+        }
+        idx = idx + 1 == self->allocated ? 0 : idx + 1;
+    }
+
+    *length = distance + 1;
+    return HASH_MAP_NOT_FOUND;
+}
+
+/**
+ * @brief Vložení offsetu záznamu do indexu metodou Robin Hood.
+ *
+ * Záznam postupuje od domovského místa a vytlačí první záznam, který je
+ * svému domovskému místu blíže. Vytlačený záznam pokračuje stejně dál, dokud
+ * některý záznam nenajde prázdné místo. Klíče se neporovnávají, klíč v indexu
+ * ještě není.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash   Haš záznamu.
+ * @param[in] offset Offset záznamu v poli záznamů.
+ */
+static void hash_map_robin_hood_place(hash_map_t* self, size_t hash, size_t offset)
+{
+    size_t idx = hash_map_robin_hood_home(self, hash);
+    size_t distance = 0;
+
+    // index je vzdy vetsi nez pocet zaznamu, prazdne misto existuje
+    while (self->ctrl[idx] != HASH_MAP_CTRL_EMPTY)
+    {
+        size_t resident = hash_map_robin_hood_distance(self, idx);
+        if (resident < distance)
+        {
+            // bohatsi zaznam uvolni misto a hleda dal
+            size_t resident_offset = hash_map_offset_get(self->index, self->index_width, idx);
+            hash_map_offset_set(self->index, self->index_width, idx, offset);
+            self->ctrl[idx] = hash_map_h2(hash);
+            if (distance > self->max_probe)
+            {
+                self->max_probe = distance;
+            }
+            offset = resident_offset;
+            hash = self->entries[offset].hash;
+            distance = resident;
+        }
+        idx = idx + 1 == self->allocated ? 0 : idx + 1;
+        distance++;
+    }
+
+    hash_map_offset_set(self->index, self->index_width, idx, offset);
+    self->ctrl[idx] = hash_map_h2(hash);
+    if (distance > self->max_probe)
+    {
+        self->max_probe = distance;
+    }
+}
+
+/**
+ * @brief Odstranění místa z indexu metodou Robin Hood.
+ *
+ * Následující posunuté záznamy se přesunou o místo zpět, dokud se nenarazí
+ * na prázdné místo nebo na záznam na svém domovském místě. Index tak
+ * neobsahuje odstraněná místa.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] idx  Uvolňované místo indexu.
+ */
+static void hash_map_robin_hood_erase(hash_map_t* self, size_t idx)
+{
+    for (;;)
+    {
+        size_t next = idx + 1 == self->allocated ? 0 : idx + 1;
+        if (self->ctrl[next] == HASH_MAP_CTRL_EMPTY || hash_map_robin_hood_distance(self, next) == 0)
+        {
+            break;
+        }
+        hash_map_offset_set(self->index, self->index_width, idx,
+                            hash_map_offset_get(self->index, self->index_width, next));
+        self->ctrl[idx] = self->ctrl[next];
+        idx = next;
+    }
+    self->ctrl[idx] = HASH_MAP_CTRL_EMPTY;
+}
+
+/**
+ * @brief Hledání v aktuálním indexu bez započtení do histogramu.
+ *
+ * @param[in]  self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key    Klíč.
+ * @param[in]  len    Délka klíče v bajtech.
+ * @param[in]  hash   Haš zadaného klíče.
+ * @param[out] found  Nastaveno na @c true , pokud byl klíč nalezen.
+ * @param[out] length Délka hledání (viz @c hash_map_count_probe ).
+ *
+ * @return Stejné návratové hodnoty jako @c hash_map_lookup_handle .
+ */
+static inline size_t hash_map_probe_current(const hash_map_t* self, const void* key, size_t len,
+                                            size_t hash, bool* found, size_t* length)
+{
+    if (self->probing == HASH_MAP_PROBING_ROBIN_HOOD)
+    {
+        return hash_map_robin_hood_probe(self, key, len, hash, found, length);
+    }
+    return hash_map_probe(self->index, self->index_width, self->ctrl, self->allocated,
+                          self->entries, key, len, hash, found, length);
+}
+
+/**
+ * @brief Výpočet indexu v hašovací tabulce v závislosti na dvojici klíč-hash.
+ *
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Klíč.
+ * @param[in]  len   Délka klíče v bajtech.
+ * @param[in]  hash  Haš zadaného klíče.
+ * @param[out] found Nastaveno na @c true , pokud byl klíč nalezen.
+ *
+ * @return Index záznamu v aktuálním indexu, nebo první volné místo v něm
+ *         (v režimu Robin Hood @c HASH_MAP_NOT_FOUND ).
+ *
+ * @see hash_map_probe, hash_map_robin_hood_probe
+ */
+size_t hash_map_lookup_handle(hash_map_t* self, const void* key, size_t len,
+                              size_t hash, bool* found)
+{
+    size_t length;
+    size_t idx = hash_map_probe_current(self, key, len, hash, found, &length);
+    hash_map_count_probe(self, *found, length);
+    return idx;
+}
+
+/**
+ * @brief Vyhledání záznamu v hašovací tabulce podle dvojice klíč-hash.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key  Klíč.
+ * @param[in] len  Délka klíče v bajtech.
+ * @param[in] hash Haš zadaného klíče.
+ *
+ * @return Index záznamu asociovaný k zadanému klíči a haši, nebo
+ *         @c HASH_MAP_NOT_FOUND .
+ *
+ * @see hash_map_lookup_handle
+ */
+size_t hash_map_lookup(hash_map_t* self, const void* key, size_t len, size_t hash)
+{
+    bool found;
+    size_t idx = hash_map_lookup_handle(self, key, len, hash, &found);
+    return found ? idx : HASH_MAP_NOT_FOUND;
+}
+
+/**
+ * @brief Vyhledání záznamu v původním indexu během postupné realokace.
+ *
+ * Délka hledání se do histogramu nezapočte, přičte se k hledání 
+ * v aktuálním indexu.
+ *
+ * @param[in]  self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key    Klíč.
+ * @param[in]  len    Délka klíče v bajtech.
+ * @param[in]  hash   Haš zadaného klíče.
+ * @param[out] length Počet prošlých skupin původního indexu.
+ *
+ * @return Index záznamu v původním indexu, nebo @c HASH_MAP_NOT_FOUND .
+ */
+static size_t hash_map_lookup_old(const hash_map_t* self, const void* key, size_t len,
+                                  size_t hash, size_t* length)
+{
+    bool found;
+    size_t idx = hash_map_probe(self->old_index, self->old_width, self->old_ctrl,
+                                self->old_allocated, self->old_entries, key, len, hash, 
+                                &found, length);
+    return found ? idx : HASH_MAP_NOT_FOUND;
+}
+
+/**
+ * @brief Umístění offsetu záznamu do aktuálního indexu bez porovnání klíčů.
+ *
+ * Při přestavbě indexu jsou klíče jistě unikátní, stačí tedy najít první
+ * volné místo na cestě hledání určené hašem. Klíče ani záznamy se přitom
+ * nečtou, prochází se jen řídicí bajty.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash   Uložený haš záznamu.
+ * @param[in] offset Offset záznamu v poli záznamů.
+ */
+static void hash_map_place(hash_map_t* self, size_t hash, size_t offset)
+{
+    if (self->probing == HASH_MAP_PROBING_ROBIN_HOOD)
+    {
+        hash_map_robin_hood_place(self, hash, offset);
+        return;
+    }
+
+    // index je vzdy vetsi nez pocet zaznamu, volne misto existuje
+    size_t idx = hash_map_ctrl_free_slot(self->ctrl, self->allocated, hash);
+    self->deleted -= hash_map_ctrl_fill(self->ctrl, idx, hash);
+    hash_map_offset_set(self->index, self->index_width, idx, offset);
+}
+
+/**
+ * @brief Alokace prázdného indexu.
+ *
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  size  Velikost indexu.
+ * @param[in]  width Šířka offsetů indexu.
+ * @param[out] index Nový index.
+ * @param[out] ctrl  Řídicí bajty nového indexu.
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_alloc_index(hash_map_t* self, size_t size,
+                                                  uint8_t width, void** index,
+                                                  uint8_t** ctrl)
+{
+    size_t ctrl_size = hash_map_groups(size)*HASH_MAP_GROUP_WIDTH;
+    void* new_index = hash_map_alloc(self, size*width);
+    uint8_t* new_ctrl = (uint8_t*)hash_map_alloc(self, ctrl_size);
+    if ((new_index == NULL && size != 0) || (new_ctrl == NULL && ctrl_size != 0))
+    {
+        // alokace pameti selhala
+        hash_map_release(self, new_index, size*width);
+        hash_map_release(self, new_ctrl, ctrl_size);
+        return MEMORY_ERROR;
+    }
+    // o platnosti offsetu rozhoduji ridici bajty
+    hash_map_ctrl_init(new_ctrl, size);
+
+    *index = new_index;
+    *ctrl = new_ctrl;
+    return OK;
+}
+
+/**
+ * @brief Uvolnění indexu.
+ *
+ * @param[in] self      Ukazatel na strukturu hašovací tabulky.
+ * @param[in] index     Uvolňovaný index.
+ * @param[in] width     Šířka offsetů uvolňovaného indexu.
+ * @param[in] ctrl      Řídicí bajty uvolňovaného indexu.
+ * @param[in] allocated Velikost uvolňovaného indexu.
+ */
+static void hash_map_release_index(hash_map_t* self, void* index, uint8_t width,
+                                   uint8_t* ctrl, size_t allocated)
+{
+    hash_map_release(self, index, allocated*width);
+    hash_map_release(self, ctrl, hash_map_groups(allocated)*HASH_MAP_GROUP_WIDTH);
+}
+
+/**
+ * @brief Uvolnění původního indexu a pole záznamů po dokončení (nebo zrušení) 
+ *        postupné realokace.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ */
+static void hash_map_drop_old(hash_map_t* self)
+{
+    hash_map_release_index(self, self->old_index, self->old_width, self->old_ctrl,
+                           self->old_allocated);
+    hash_map_release(self, self->old_entries, self->old_entries_allocated*sizeof(hash_map_item_t));
+    self->old_index = NULL;
+    self->old_ctrl = NULL;
+    self->old_allocated = 0;
+    self->old_width = 1;
+    self->old_entries = NULL;
+    self->old_entries_used = 0;
+    self->old_entries_allocated = 0;
+    self->migrated = 0;
+    self->copied = 0;
+    self->entries_base = 0;
+}
+
+/**
+ * @brief Setřesení živých záznamů do nově alokovaného pole.
+ *
+ * Odstraněné záznamy se vynechají, tím se mění offsety záznamů a index je 
+ * pak nutné přestavět. Záznamy probíhající postupné realokace se převezmou 
+ * z obou polí v pořadí vložení.
+ *
+ * @param[in] self     Ukazatel na strukturu hašovací tabulky.
+ * @param[in] capacity Kapacita nového pole.
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_move_entries(hash_map_t* self, size_t capacity)
+{
+    hash_map_item_t* entries = (hash_map_item_t*)hash_map_alloc(self, capacity*sizeof(hash_map_item_t));
+    if (entries == NULL && capacity != 0)
+    {
+        // alokace pameti selhala
+        return MEMORY_ERROR;
+    }
+
+    size_t used = 0;
+    for (hash_map_item_t* item = hash_map_next(self, NULL); item != NULL; 
+         item = hash_map_next(self, item))
+    {
+        entries[used++] = *item;
+    }
+
+    hash_map_release(self, self->entries, self->entries_allocated*sizeof(hash_map_item_t));
+    self->entries = entries;
+    self->entries_used = used;
+    self->entries_allocated = capacity;
+    self->first = used != 0 ? entries : NULL;
+    self->last = used != 0 ? entries + used - 1 : NULL;
+    return OK;
+}
+
+/**
+ * @brief Přestavba indexu hašovací tabulky.
+ *
+ * Alokuje nový index zadané velikosti, setřese pole záznamů (vynechá
+ * odstraněné záznamy) a vloží do indexu offsety všech záznamů. Volá se
+ * i se stávající velikostí indexu, pokud je potřeba uklidit odstraněné
+ * záznamy. Probíhající postupná realokace je tím dokončena.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] size Velikost nového indexu, alespoň počet vložených záznamů.
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_rehash(hash_map_t* self, size_t size)
+{
+    // velikost by pretekla pri vypoctu alokovane pameti
+    if (size > SIZE_MAX / sizeof(hash_map_item_t) - HASH_MAP_GROUP_WIDTH)
+    {
+        return MEMORY_ERROR;
+    }
+
+#if HASH_MAP_STATS
+    // prvni alokace indexu neni prestavba
+    bool rebuild = self->allocated > 0;
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+#endif
+
+    size_t capacity = hash_map_entries_capacity(size, self->used);
+    uint8_t width = hash_map_offset_width(capacity);
+    void* new_index;
+    uint8_t* new_ctrl;
+    if (hash_map_alloc_index(self, size, width, &new_index, &new_ctrl) == MEMORY_ERROR)
+    {
+        return MEMORY_ERROR;
+    }
+    if (hash_map_move_entries(self, capacity) == MEMORY_ERROR)
+    {
+        hash_map_release_index(self, new_index, width, new_ctrl, size);
+        return MEMORY_ERROR;
+    }
+
+    // nahrazeni stareho indexu (i z probihajici postupne realokace),
+    // odstranene zaznamy v nem nezustanou
+    hash_map_release_index(self, self->index, self->index_width, self->ctrl, self->allocated);
+    hash_map_drop_old(self);
+    self->index = new_index;
+    self->index_width = width;
+    self->ctrl = new_ctrl;
+    self->allocated = size;
+    self->deleted = 0;
+    self->max_probe = 0;
+
+    // vlozeni offsetu vsech zaznamu jednim pruchodem polem podle ulozenych
+    // hasu, bez hledani a porovnavani klicu
+    for (size_t i = 0; i < self->entries_used; ++i)
+    {
+        hash_map_place(self, self->entries[i].hash, i);
+    }
+
+#if HASH_MAP_STATS
+    if (rebuild)
+    {
+        struct timespec end;
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        self->counters.resizes++;
+        self->counters.rehash_ns += (uint64_t)(end.tv_sec - start.tv_sec)*1000000000u + 
+                                    (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+    }
+#endif
+    return OK;
+}
+
+/**
+ * @brief Kontext hledání offsetu v původním indexu.
+ */
+typedef struct hash_map_offset_match
+{
+    const void* index; ///< Původní index
+    uint8_t width;     ///< Šířka offsetů původního indexu
+    size_t offset;     ///< Hledaný offset
+} hash_map_offset_match_t;
+
+/**
+ * @brief Porovnání offsetu na místě indexu (viz @c hash_map_ctrl_match_t ).
+ */
+static inline bool hash_map_offset_match(const void* ctx, size_t idx)
+{
+    const hash_map_offset_match_t* match = (const hash_map_offset_match_t*)ctx;
+    return hash_map_offset_get(match->index, match->width, idx) == match->offset;
+}
+
+/**
+ * @brief Místo původního indexu, které ukazuje na daný záznam původního pole.
+ *
+ * Prochází se cesta hledání určená hašem, klíče se neporovnávají, stačí 
+ * shoda offsetu.
+ *
+ * @param[in] self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash   Uložený haš záznamu.
+ * @param[in] offset Offset živého záznamu v původním poli.
+ *
+ * @return Místo původního indexu.
+ */
+static size_t hash_map_old_slot(const hash_map_t* self, size_t hash, size_t offset)
+{
+    hash_map_offset_match_t match = { self->old_index, self->old_width, offset };
+    bool found;
+    size_t length;
+    // zivy zaznam v puvodnim indexu jiste je
+    return hash_map_ctrl_probe(self->old_ctrl, self->old_allocated, hash, hash_map_offset_match,
+                               &match, &found, &length);
+}
+
+/**
+ * @brief Krok postupné realokace.
+ *
+ * Přesune nejvýše @p steps záznamů původního pole na začátek nového pole 
+ * a jejich offsety vloží do aktuálního indexu. Odstraněné záznamy se 
+ * vynechají, místo po nich zbylé před připojenými záznamy se označí jako 
+ * odstraněné záznamy. Po zpracování celého původního pole uvolní původní 
+ * pole i index.
+ *
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] steps Počet zpracovaných záznamů.
+ */
+static void hash_map_migrate(hash_map_t* self, size_t steps)
+{
+    for (; steps > 0 && self->migrated < self->old_entries_used; --steps, ++self->migrated)
+    {
+        hash_map_item_t* item = self->old_entries + self->migrated;
+        if (item->key == NULL)
+        {
+            continue;
+        }
+        size_t offset = self->copied++;
+        self->entries[offset] = *item;
+        // presunuty zaznam uz v puvodnim indexu neni, hledani jim ale dal
+        // prochazi
+        self->old_ctrl[hash_map_old_slot(self, item->hash, self->migrated)] = HASH_MAP_CTRL_DELETED;
+        // klic v novem indexu jiste chybi, staci volne misto podle hase
+        hash_map_place(self, item->hash, offset);
+        if (self->first == item)
+        {
+            self->first = self->entries + offset;
+        }
+        if (self->last == item)
+        {
+            self->last = self->entries + offset;
+        }
+    }
+    for (; steps > 0 && self->copied < self->entries_base; --steps)
+    {
+        self->entries[self->copied++].key = NULL;
+    }
+
+    if (self->old_index != NULL && self->migrated == self->old_entries_used && 
+        self->copied == self->entries_base)
+    {
+        hash_map_drop_old(self);
+    }
+}
+
+/**
+ * @brief Následující záznam v pořadí vložení, včetně odstraněných záznamů.
+ *
+ * Během postupné realokace následují po záznamech přesunutých na začátek 
+ * nového pole zbývající záznamy původního pole a za nimi záznamy připojené 
+ * od @c entries_base .
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] item Záznam v poli záznamů.
+ *
+ * @return Ukazatel na následující záznam, nebo @c NULL .
+ */
+static hash_map_item_t* hash_map_entry_after(const hash_map_t* self, hash_map_item_t* item)
+{
+    hash_map_item_t* end = self->entries + self->entries_used;
+    if (self->old_index == NULL)
+    {
+        return ++item < end ? item : NULL;
+    }
+
+    hash_map_item_t* old_end = self->old_entries + self->old_entries_used;
+    if (item >= self->old_entries && item < old_end)
+    {
+        if (++item < old_end)
+        {
+            return item;
+        }
+        item = self->entries + self->entries_base;
+    }
+    else if (++item == self->entries + self->copied)
+    {
+        // za presunutymi zaznamy nasleduje zbytek puvodniho pole
+        if (self->migrated < self->old_entries_used)
+        {
+            return self->old_entries + self->migrated;
+        }
+        item = self->entries + self->entries_base;
+    }
+    return item < end ? item : NULL;
+}
+
+/**
+ * @brief Uvolnění odstraněných záznamů na konci pořadí vložení.
+ *
+ * Poslední záznam je pak vždy živý. Během postupné realokace se připojené 
+ * záznamy zkracují nejvýše po @c entries_base , dál zbytek původního pole 
+ * a nakonec přesunuté záznamy.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ */
+static void hash_map_trim(hash_map_t* self)
+{
+    size_t base = self->old_index != NULL ? self->entries_base : 0;
+    while (self->entries_used > base && self->entries[self->entries_used - 1].key == NULL)
+    {
+        self->entries_used--;
+    }
+    if (self->entries_used > base || self->old_index == NULL)
+    {
+        self->last = self->entries_used > 0 ? self->entries + self->entries_used - 1 : NULL;
+        return;
+    }
+
+    while (self->old_entries_used > self->migrated && 
+           self->old_entries[self->old_entries_used - 1].key == NULL)
+    {
+        self->old_entries_used--;
+    }
+    if (self->old_entries_used > self->migrated)
+    {
+        self->last = self->old_entries + self->old_entries_used - 1;
+        return;
+    }
+    // uvolnene misto se oznaci jako odstranene zaznamy pri dokonceni presunu
+    while (self->copied > 0 && self->entries[self->copied - 1].key == NULL)
+    {
+        self->copied--;
+    }
+    self->last = self->copied > 0 ? self->entries + self->copied - 1 : NULL;
+}
+
+/**
+ * @brief Automatická změna velikosti indexu při vkládání a odstraňování.
+ *
+ * V režimu postupné realokace pouze alokuje nový prázdný index a nové pole 
+ * záznamů, původní index i pole ponechá k postupnému přesunu (viz 
+ * @c hash_map_migrate ). Začátek nového pole je vyhrazen živým záznamům, 
+ * nové záznamy se připojují za něj. Jinak index přestaví najednou.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] size Velikost nového indexu.
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_resize(hash_map_t* self, size_t size)
+{
+    // predchozi realokace musi byt dokoncena
+    hash_map_migrate(self, SIZE_MAX);
+
+    if (!self->incremental || self->probing == HASH_MAP_PROBING_ROBIN_HOOD)
+    {
+        return hash_map_rehash(self, size);
+    }
+    if (size > SIZE_MAX / sizeof(hash_map_item_t) - HASH_MAP_GROUP_WIDTH)
+    {
+        return MEMORY_ERROR;
+    }
+
+    // kazda operace presune HASH_MAP_MIGRATION_STEP zaznamu a pripoji nejvyse 
+    // jeden, pole se behem presunu nezaplni
+    size_t steps = (self->entries_used + self->used) / HASH_MAP_MIGRATION_STEP + 1;
+    size_t capacity = hash_map_entries_capacity(size, self->used + steps);
+    uint8_t width = hash_map_offset_width(capacity);
+    void* new_index;
+    uint8_t* new_ctrl;
+    if (hash_map_alloc_index(self, size, width, &new_index, &new_ctrl) == MEMORY_ERROR)
+    {
+        return MEMORY_ERROR;
+    }
+    hash_map_item_t* entries = (hash_map_item_t*)hash_map_alloc(self, capacity*sizeof(hash_map_item_t));
+    if (entries == NULL)
+    {
+        // alokace pameti selhala
+        hash_map_release_index(self, new_index, width, new_ctrl, size);
+        return MEMORY_ERROR;
+    }
+
+    // prvni a posledni zaznam zustavaji v puvodnim poli do sveho presunu
+    self->old_entries = self->entries;
+    self->old_entries_used = self->entries_used;
+    self->old_entries_allocated = self->entries_allocated;
+    self->copied = 0;
+    self->entries_base = self->used;
+    self->entries = entries;
+    self->entries_used = self->used;
+    self->entries_allocated = capacity;
+    self->old_index = self->index;
+    self->old_width = self->index_width;
+    self->old_ctrl = self->ctrl;
+    self->old_allocated = self->allocated;
+    self->migrated = 0;
+    self->index = new_index;
+    self->index_width = width;
+    self->ctrl = new_ctrl;
+    self->allocated = size;
+    self->deleted = 0;
+#if HASH_MAP_STATS
+    self->counters.resizes++;
+#endif
+
+    return OK;
+}
+
+/**
+ * @brief Inicializace hašovací tabulky.
+ *
+ * Metoda alokuje a inicializuje položky struktury hašovací tabulky.
+ *
+ * @param self[in] Ukazatel na neinicializovanou hašovací tabulku
+ * @param size[in] Počet prvků v tabulce.
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+hash_map_state_code_t hash_map_init(hash_map_t* self, size_t size)
+{
+    self->entries = NULL;
+    self->entries_used = 0;
+    self->entries_allocated = 0;
+    self->first = self->last = NULL;
+    self->used = 0;
+    self->deleted = 0;
+    self->allocated = 0;
+    self->reserved = 0;
+    self->index = NULL;
+    self->index_width = 1;
+    self->ctrl = NULL;
+    self->old_index = NULL;
+    self->old_width = 1;
+    self->old_ctrl = NULL;
+    self->old_allocated = 0;
+    self->old_entries = NULL;
+    self->old_entries_used = 0;
+    self->old_entries_allocated = 0;
+    self->migrated = 0;
+    self->copied = 0;
+    self->entries_base = 0;
+    self->incremental = false;
+    self->max_probe = 0;
+    self->seed = HASH_FUNCTION_SEED;
+    self->count_probes = true;
+    memset(&self->counters, 0, sizeof(self->counters));
+    hash_map_slab_init(&self->slab);
+
+    return hash_map_reserve(self, size);
+}
+
+/*******************************************************************************
+ * Operace s předem spočítaným hašem klíče.
+ ******************************************************************************/
+/**
+ * @brief Nalezení záznamu se zadaným hašem klíče.
+ *
+ * @param[in]  self Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key  Klíč.
+ * @param[in]  len  Délka klíče v bajtech.
+ * @param[in]  hash Haš klíče spočítaný se semínkem tabulky.
+ * @param[out] old  Nastaveno na @c true , pokud je záznam zatím v původním
+ *                  indexu, může být @c NULL .
+ * @param[out] slot Místo záznamu v (aktuálním nebo původním) indexu, může být
+ *                  @c NULL .
+ *
+ * @return Ukazatel na záznam, nebo @c NULL pokud záznam neexistuje.
+ */
+static hash_map_item_t* hash_map_find_hashed(hash_map_t* self, const void* key, size_t len,
+                                             size_t hash, bool* old, size_t* slot)
+{
+    const void* index = self->index;
+    uint8_t width = self->index_width;
+    bool found;
+    size_t length;
+    size_t idx = hash_map_probe_current(self, key, len, hash, &found, &length);
+
+    if (!found && self->old_index != NULL)
+    {
+        // zaznam mohl zatim zustat v puvodnim indexu
+        size_t old_length;
+        index = self->old_index;
+        width = self->old_width;
+        idx = hash_map_lookup_old(self, key, len, hash, &old_length);
+        found = idx != HASH_MAP_NOT_FOUND;
+        length += old_length;
+    }
+    // hledani v obou indexech je jedno hledani
+    hash_map_count_probe(self, found, length);
+    if (!found)
+    {
+        return NULL;
+    }
+
+    if (old != NULL)
+    {
+        *old = index != self->index;
+    }
+    if (slot != NULL)
+    {
+        *slot = idx;
+    }
+    // zaznam z puvodniho indexu jeste nebyl presunut z puvodniho pole
+    hash_map_item_t* entries = index != self->index ? self->old_entries : self->entries;
+    return entries + hash_map_offset_get(index, width, idx);
+}
+
+/**
+ * @brief Obsahuje tabulka záznam s daným klíčem?
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key  Klíč.
+ * @param[in] len  Délka klíče v bajtech.
+ * @param[in] hash Haš klíče spočítaný se semínkem tabulky.
+ *
+ * @see hash_map_contains
+ */
+static bool hash_map_contains_hashed(hash_map_t* self, const void* key, size_t len,
+                                     size_t hash)
+{
+    return hash_map_find_hashed(self, key, len, hash, NULL, NULL) != NULL;
+}
+
+/**
+ * @brief Přesun záznamu na konec pole záznamů v režimu cache.
+ *
+ * Záznam se zkopíruje za poslední záznam pole, původní místo zůstane jako 
+ * odstraněný záznam a místo indexu dostane nový offset. Záznam z původního 
+ * indexu (při postupné realokaci) se rovnou přesune do aktuálního indexu. 
+ * Je-li pole zaplněné, setřese se přestavbou indexu stejné velikosti.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] item Nalezený záznam.
+ * @param[in] old  Je záznam v původním indexu?
+ * @param[in] idx  Místo záznamu v indexu.
+ *
+ * @return Ukazatel na záznam po přesunu.
+ */
+static hash_map_item_t* hash_map_touch(hash_map_t* self, hash_map_item_t* item, bool old, 
+                                       size_t idx)
+{
+    if (self->cache_capacity == 0 || item == self->last)
+    {
+        return item;
+    }
+
+    if (self->entries_used == self->entries_allocated)
+    {
+        // setreseni pole zaznamu, zaznam a jeho misto se zmeni; pokud by 
+        // setrese pole nemelo volne misto, index se zdvojnasobi
+        const char* key = item->key;
+        size_t len = item->key_len;
+        size_t hash = item->hash;
+        size_t size = hash_map_entries_capacity(self->allocated, self->used) > self->used ? 
+                      self->allocated : self->allocated<<1;
+        if (hash_map_rehash(self, size) == MEMORY_ERROR)
+        {
+            // poradi zustane bez zmeny
+            return item;
+        }
+        item = hash_map_find_hashed(self, key, len, hash, &old, &idx);
+        if (item == self->last)
+        {
+            return item;
+        }
+    }
+
+    size_t offset = self->entries_used++;
+    hash_map_item_t* moved = self->entries + offset;
+    *moved = *item;
+    item->key = NULL;
+    if (old)
+    {
+        // offset by se do uzsiho puvodniho indexu nemusel vejit
+        self->old_ctrl[idx] = HASH_MAP_CTRL_DELETED;
+        hash_map_place(self, moved->hash, offset);
+    }
+    else
+    {
+        hash_map_offset_set(self->index, self->index_width, idx, offset);
+    }
+
+    if (item == self->first)
+    {
+        // za presunutym zaznamem je nejpozdeji on sam
+        self->first = hash_map_next(self, item);
+    }
+    self->last = moved;
+    return moved;
+}
+
+/**
+ * @brief Nalezení záznamu se zadaným hašem klíče a jeho označení jako 
+ *        naposledy použitého.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key  Klíč.
+ * @param[in] len  Délka klíče v bajtech.
+ * @param[in] hash Haš klíče spočítaný se semínkem tabulky.
+ *
+ * @return Ukazatel na záznam, nebo @c NULL pokud záznam neexistuje.
+ *
+ * @see hash_map_touch
+ */
+static hash_map_item_t* hash_map_use_hashed(hash_map_t* self, const void* key, size_t len,
+                                            size_t hash)
+{
+    if (self->cache_capacity != 0)
+    {
+        // cteni v rezimu cache pripojuje zaznamy, posouva proto i presun
+        hash_map_migrate(self, HASH_MAP_MIGRATION_STEP);
+    }
+
+    bool old;
+    size_t idx;
+    hash_map_item_t* item = hash_map_find_hashed(self, key, len, hash, &old, &idx);
+    return item != NULL ? hash_map_touch(self, item, old, idx) : NULL;
+}
+
+static hash_map_state_code_t hash_map_pop_hashed(hash_map_t* self, const void* key,
+                                                 size_t len, size_t hash, int* dst);
+
+/**
+ * @brief Vyřazení nejdéle nepoužitého záznamu v režimu cache.
+ *
+ * @param[in] self Ukazatel na neprázdnou hašovací tabulku.
+ */
+static void hash_map_evict(hash_map_t* self)
+{
+    hash_map_item_t* item = self->first;
+    if (self->evict != NULL)
+    {
+        self->evict(self->evict_ctx, item);
+    }
+    int value;
+    hash_map_pop_hashed(self, item->key, item->key_len, item->hash, &value);
+}
+
+/**
+ * @brief Nalezení záznamu se zadaným hašem klíče, případně jeho vložení.
+ *
+ * Jediné hledání slouží jak ke zjištění existence klíče, tak k nalezení místa
+ * pro nový záznam. Na tomto základě jsou postaveny všechny vkládací operace.
+ *
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Klíč.
+ * @param[in]  len   Délka klíče v bajtech.
+ * @param[in]  hash  Haš klíče spočítaný se semínkem tabulky.
+ * @param[in]  value Hodnota nově vloženého záznamu.
+ * @param[out] found_item Nalezený nebo vložený záznam.
+ *
+ * @return @c KEY_ALREADY_EXISTS pokud záznam existoval, @c MEMORY_ERROR pokud
+ *         se jej nepodařilo vložit, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_upsert_hashed(hash_map_t* self, const void* key,
+                                                    size_t len, size_t hash, int value,
+                                                    hash_map_item_t** found_item)
+{
+    // je potreba realokovat misto? Odstranena mista prodluzuji hledani stejne
+    // jako zive zaznamy, odstranene zaznamy zabiraji pole zaznamu.
+    if (self->allocated == 0)
+    {
+        hash_map_rehash(self, HASH_MAP_INIT_SIZE);
+    }
+    else if (hash_map_needs_resize(self->used, self->deleted, self->allocated) ||
+             self->entries_used == self->entries_allocated)
+    {
+        hash_map_resize(self, hash_map_grow_size(self->used, self->allocated));
+    }
+
+    // posun probihajici postupne realokace
+    hash_map_migrate(self, HASH_MAP_MIGRATION_STEP);
+
+    // zaznam mohl zatim zustat v puvodnim indexu
+    size_t old_length = 0;
+    if (self->old_index != NULL)
+    {
+        size_t old_idx = hash_map_lookup_old(self, key, len, hash, &old_length);
+        if (old_idx != HASH_MAP_NOT_FOUND)
+        {
+            hash_map_count_probe(self, true, old_length);
+            *found_item = hash_map_touch(self, self->old_entries + 
+                                         hash_map_offset_get(self->old_index, self->old_width, old_idx), 
+                                         true, old_idx);
+            return KEY_ALREADY_EXISTS;
+        }
+    }
+
+    bool found;
+    size_t length;
+    size_t idx = hash_map_probe_current(self, key, len, hash, &found, &length);
+    // hledani v obou indexech je jedno hledani
+    hash_map_count_probe(self, found, old_length + length);
+
+    if (found)
+    {
+        *found_item = hash_map_touch(self, self->entries + 
+                                     hash_map_offset_get(self->index, self->index_width, idx), 
+                                     false, idx);
+        return KEY_ALREADY_EXISTS;
+    }
+    if (self->cache_capacity != 0 && self->used >= self->cache_capacity)
+    {
+        // misto pro novy zaznam uvolni nejdele nepouzity zaznam
+        hash_map_evict(self);
+        // misto se hleda znovu, hledani uz je zapocteno
+        idx = hash_map_probe_current(self, key, len, hash, &found, &length);
+    }
+    bool robin_hood = self->probing == HASH_MAP_PROBING_ROBIN_HOOD;
+    if ((idx == HASH_MAP_NOT_FOUND && !robin_hood) || self->entries_used == self->entries_allocated)
+    {
+        // index ani pole zaznamu se nepodarilo zvetsit a jsou zaplneny
+        return MEMORY_ERROR;
+    }
+
+    // prazdne misto v indexu nebo odstraneny zaznam
+    // Vizte hash_map_lookup_handle
+    // Klic je ulozen ve slabu ukonceny nulou, aby retezcove klice zustaly
+    // citelne jako retezce.
+    char* key_copy = (char*)hash_map_slab_alloc(self, hash_map_key_size(self, len));
+    if (key_copy == NULL)
+    {
+        // alokace pameti selhala
+        return MEMORY_ERROR;
+    }
+    memcpy(key_copy, key, len);
+    key_copy[len] = '\0';
+
+    // novy zaznam se pripoji na konec pole zaznamu
+    size_t offset = self->entries_used++;
+    hash_map_item_t* item = self->entries + offset;
+    item->key = key_copy;
+    item->key_len = len;
+    item->hash = hash;
+    item->value_u64 = 0;
+    item->value = value;
+    if (self->value_size != 0)
+    {
+        memset(key_copy + hash_map_value_offset(len), 0, self->value_size);
+    }
+    if (robin_hood)
+    {
+        // misto urci az presuny zaznamu
+        hash_map_robin_hood_place(self, hash, offset);
+    }
+    else
+    {
+        // vkladame na misto odstraneneho zaznamu?
+        self->deleted -= hash_map_ctrl_fill(self->ctrl, idx, hash);
+        hash_map_offset_set(self->index, self->index_width, idx, offset);
+    }
+    self->used++;
+    // je seznam zaznamu prazdny?
+    if (self->first == NULL)
+    {
+        self->first = item;
+    }
+    self->last = item;
+    *found_item = item;
+    return OK;
+}
+
+/**
+ * @brief Vložení záznamu se zadaným hašem klíče.
+ *
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key   Klíč.
+ * @param[in] len   Délka klíče v bajtech.
+ * @param[in] hash  Haš klíče spočítaný se semínkem tabulky.
+ * @param[in] value Hodnota.
+ *
+ * @see hash_map_put
+ */
+static hash_map_state_code_t hash_map_put_hashed(hash_map_t* self, const void* key,
+                                                 size_t len, size_t hash, int value)
+{
+    hash_map_item_t* item;
+    hash_map_state_code_t state = hash_map_upsert_hashed(self, key, len, hash, value, &item);
+    if (state == KEY_ALREADY_EXISTS)
+    {
+        item->value = value;
+    }
+    return state;
+}
+
+/**
+ * @brief Přičtení hodnoty k záznamu se zadaným hašem klíče.
+ *
+ * @param[in]  self      Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key       Klíč.
+ * @param[in]  len       Délka klíče v bajtech.
+ * @param[in]  hash      Haš klíče spočítaný se semínkem tabulky.
+ * @param[in]  delta     Přičítaná hodnota.
+ * @param[out] new_value Výsledná hodnota, může být @c NULL .
+ *
+ * @see hash_map_increment
+ */
+static hash_map_state_code_t hash_map_increment_hashed(hash_map_t* self, const void* key,
+                                                       size_t len, size_t hash, int delta,
+                                                       int* new_value)
+{
+    hash_map_item_t* item;
+    hash_map_state_code_t state = hash_map_upsert_hashed(self, key, len, hash, delta, &item);
+    if (state == MEMORY_ERROR)
+    {
+        return MEMORY_ERROR;
+    }
+    if (state == KEY_ALREADY_EXISTS)
+    {
+        item->value += delta;
+    }
+    if (new_value != NULL)
+    {
+        *new_value = item->value;
+    }
+    return OK;
+}
+
+/**
+ * @brief Získání hodnoty záznamu se zadaným hašem klíče.
+ *
+ * @param[in]  self Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key  Klíč.
+ * @param[in]  len  Délka klíče v bajtech.
+ * @param[in]  hash Haš klíče spočítaný se semínkem tabulky.
+ * @param[out] dst  Ukazatel na místo, kde se uloží hodnota.
+ *
+ * @see hash_map_get
+ */
+static hash_map_state_code_t hash_map_get_hashed(hash_map_t* self, const void* key,
+                                                 size_t len, size_t hash, int* dst)
+{
+    hash_map_item_t* item = hash_map_use_hashed(self, key, len, hash);
+
+    if (item == NULL)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+
+    *dst = item->value;
+
+    return OK;
+}
+
+/**
+ * @brief Odstranění záznamu se zadaným hašem klíče.
+ *
+ * @param[in]  self Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key  Klíč.
+ * @param[in]  len  Délka klíče v bajtech.
+ * @param[in]  hash Haš klíče spočítaný se semínkem tabulky.
+ * @param[out] dst  Ukazatel na místo, kde se uloží hodnota.
+ *
+ * @see hash_map_pop
+ */
+static hash_map_state_code_t hash_map_pop_hashed(hash_map_t* self, const void* key,
+                                                 size_t len, size_t hash, int* dst)
+{
+    // posun probihajici postupne realokace
+    hash_map_migrate(self, HASH_MAP_MIGRATION_STEP);
+
+    bool old;
+    size_t idx;
+    hash_map_item_t* item = hash_map_find_hashed(self, key, len, hash, &old, &idx);
+
+    if (item == NULL)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+    else
+    {
+        // uloz hodnotu
+        *dst = item->value;
+        // smaz klic, zaznam v poli zustane jako odstraneny
+        hash_map_slab_free(self, item->key, hash_map_key_size(self, item->key_len));
+        item->key = NULL;
+        self->used--;
+
+        // jedna se o prvni zaznam v seznamu?
+        if (item == self->first)
+        {
+            self->first = hash_map_next(self, item);
+        }
+        // odstranene zaznamy na konci poradi se hned uvolni, posledni zaznam
+        // je tak vzdy zivy
+        hash_map_trim(self);
+
+        uint8_t* ctrl = old ? self->old_ctrl : self->ctrl;
+        if (self->probing == HASH_MAP_PROBING_ROBIN_HOOD)
+        {
+            // posunute zaznamy se vrati blize domovskemu mistu, odstranene
+            // misto nevznikne
+            hash_map_robin_hood_erase(self, idx);
+        }
+        // puvodni index se uz jen vyprazdnuje
+        else if (hash_map_ctrl_erase(ctrl, idx))
+        {
+            self->deleted += !old;
+        }
+
+        // zmenseni indexu pri nizkem zaplneni, behem presunu se nezmensuje
+        size_t size = hash_map_shrink_size(self->used, self->allocated, self->reserved);
+        if (self->old_index == NULL && size != self->allocated)
+        {
+            hash_map_rehash(self, size);
+        }
+    }
+
+    return OK;
+}
+
+/**
+ * @brief Místo indexu, na kterém začíná hledání haše.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky s neprázdným indexem.
+ * @param[in] hash Haš klíče.
+ *
+ * @return Začátek domovské skupiny, v režimu Robin Hood domovské místo.
+ */
+static inline size_t hash_map_home_slot(hash_map_t* self, size_t hash)
+{
+    if (self->probing == HASH_MAP_PROBING_ROBIN_HOOD)
+    {
+        return hash_map_robin_hood_home(self, hash);
+    }
+    return (hash >> 7) % hash_map_groups(self->allocated) * HASH_MAP_GROUP_WIDTH;
+}
+
+/**
+ * @brief Požádá o načtení skupiny indexu, ve které začíná hledání haše.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash Haš klíče.
+ */
+static inline void hash_map_prefetch_group(hash_map_t* self, size_t hash)
+{
+    if (self->allocated == 0)
+    {
+        return;
+    }
+    size_t idx = hash_map_home_slot(self, hash);
+    HASH_MAP_PREFETCH(self->ctrl + idx);
+    HASH_MAP_PREFETCH((const uint8_t*)self->index + idx*self->index_width);
+}
+
+/**
+ * @brief Požádá o načtení prvního záznamu se shodným otiskem haše.
+ *
+ * Předpokládá, že skupina již byla načtena pomocí
+ * @c hash_map_prefetch_group . Klíč záznamu se nenačítá, čtení ukazatele 
+ * na klíč by čekalo na právě vyžádaný záznam; k tomu slouží 
+ * @c hash_map_prefetch_key v dalším průchodu dávkou.
+ *
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] hash Haš klíče.
+ *
+ * @return Ukazatel na kandidátní záznam, nebo @c NULL .
+ */
+static inline const hash_map_item_t* hash_map_prefetch_item(hash_map_t* self, size_t hash)
+{
+    if (self->allocated == 0)
+    {
+        return NULL;
+    }
+    size_t idx = hash_map_home_slot(self, hash);
+    const hash_map_item_t* item = NULL;
+    if (self->probing == HASH_MAP_PROBING_ROBIN_HOOD)
+    {
+        // domovske misto patri klici jen pri shode otisku
+        if (self->ctrl[idx] == hash_map_h2(hash))
+        {
+            item = self->entries + hash_map_offset_get(self->index, self->index_width, idx);
+        }
+    }
+    else
+    {
+        uint32_t mask = hash_map_group_match(self->ctrl + idx, hash_map_h2(hash));
+        if (mask != 0)
+        {
+            item = self->entries + hash_map_offset_get(self->index, self->index_width,
+                                                       idx + __builtin_ctz(mask));
+        }
+    }
+    if (item != NULL)
+    {
+        HASH_MAP_PREFETCH(item);
+    }
+    return item;
+}
+
+/**
+ * @brief Požádá o načtení klíče kandidátního záznamu.
+ *
+ * Volá se až po @c hash_map_prefetch_item pro celou dávku, záznam je tak 
+ * v době čtení ukazatele na klíč již načten nebo na cestě.
+ *
+ * @param[in] item Kandidátní záznam, nebo @c NULL .
+ */
+static inline void hash_map_prefetch_key(const hash_map_item_t* item)
+{
+    if (item != NULL)
+    {
+        HASH_MAP_PREFETCH(item->key);
+    }
+}
+
+/**
+ * @brief Vytvoření hašovací tabulky.
+ *
+ * @param[in] allocator Alokátor, hodnota @c NULL znamená @c malloc a @c free .
+ * @param[in] probing   Způsob prohledávání indexu.
+ * @param[in] value_size Velikost hodnoty uložené za klíčem, nebo 0.
+ *
+ * @return Ukazatel na inicializovanou tabulku, nebo @c NULL při chybě alokace.
+ */
+static hash_map_t* hash_map_create(const hash_map_allocator_t* allocator,
+                                   hash_map_probing_t probing, size_t value_size)
+{
+    if (allocator == NULL)
+    {
+        allocator = &hash_map_default_allocator;
+    }
+
+    hash_map_t* map = (hash_map_t*)allocator->alloc(allocator->ctx, sizeof(hash_map_t));
+    if (map == NULL)
+    {
+        return NULL;
+    }
+    map->allocator = *allocator;
+    map->probing = probing;
+    map->value_size = value_size;
+    map->cache_capacity = 0;
+    map->evict = NULL;
+    map->evict_ctx = NULL;
+    if (hash_map_init(map, HASH_MAP_INIT_SIZE) == MEMORY_ERROR) 
+    {
+        allocator->release(allocator->ctx, map, sizeof(hash_map_t));
+        map = NULL;
+    }
+    return map;
+}
+
+/*******************************************************************************
+ * Definice veřejných metod.
+ ******************************************************************************/
+
+hash_map_t* hash_map_ctor()
+{
+    return hash_map_ctor_with_allocator(NULL);
+}
+
+hash_map_t* hash_map_ctor_with_allocator(const hash_map_allocator_t* allocator)
+{
+    return hash_map_create(allocator, HASH_MAP_PROBING_GROUPS, 0);
+}
+
+hash_map_t* hash_map_ctor_with_probing(hash_map_probing_t probing)
+{
+    return hash_map_create(NULL, probing, 0);
+}
+
+hash_map_t* hash_map_ctor_with_value_size(size_t value_size)
+{
+    return hash_map_create(NULL, HASH_MAP_PROBING_GROUPS, value_size);
+}
+
+hash_map_t* hash_map_ctor_lru(size_t capacity, hash_map_evict_t evict, void* ctx)
+{
+    if (capacity == 0)
+    {
+        return NULL;
+    }
+    hash_map_t* map = hash_map_create(NULL, HASH_MAP_PROBING_GROUPS, 0);
+    if (map != NULL)
+    {
+        map->cache_capacity = capacity;
+        map->evict = evict;
+        map->evict_ctx = ctx;
+    }
+    return map;
+}
+
+void hash_map_clear(hash_map_t* self)
+{
+    // klice mimo slab je treba uvolnit jednotlive, i ze zaznamu zatim 
+    // nepresunutych z puvodniho pole
+    for (hash_map_item_t* item = hash_map_next(self, NULL); item != NULL && self->slab.large > 0; 
+         item = hash_map_next(self, item))
+    {
+        if (hash_map_key_size(self, item->key_len) > HASH_MAP_SLAB_MAX_BLOCK)
+        {
+            hash_map_slab_free(self, item->key, hash_map_key_size(self, item->key_len));
+        }
+    }
+    // ostatni klice zmizi najednou s bloky slabu
+    hash_map_slab_release(self);
+    // probihajici postupna realokace uz nema co presouvat
+    hash_map_drop_old(self);
+
+    memset(self->ctrl, HASH_MAP_CTRL_EMPTY, self->allocated);
+
+    self->entries_used = 0;
+    self->max_probe = 0;
+    self->first = NULL;
+    self->last = NULL;
+    self->used = 0;
+    self->deleted = 0;
+}
+
+void hash_map_dtor(hash_map_t* self)
+{
+    hash_map_clear(self);
+    hash_map_release_index(self, self->index, self->index_width, self->ctrl, self->allocated);
+    hash_map_release(self, self->entries, self->entries_allocated*sizeof(hash_map_item_t));
+    self->index = NULL;
+    self->ctrl = NULL;
+    self->allocated = 0;
+    self->entries = NULL;
+    self->entries_allocated = 0;
+    hash_map_release(self, self, sizeof(hash_map_t));
+}
+
+hash_map_state_code_t hash_map_reserve(hash_map_t* self, size_t size)
+{
+    // chceme alokovat mene mista nez je vlozenych zaznamu?
+    if (size < self->used)
+    {
+        return VALUE_ERROR;
+    }
+
+    // je jiz alokovano?
+    if (size != self->allocated && hash_map_rehash(self, size) == MEMORY_ERROR)
+    {
+        // index zustal puvodni, mez pro zmenseni take
+        return MEMORY_ERROR;
+    }
+
+    // pod rezervovanou velikost se index automaticky nezmensi
+    self->reserved = size;
+    return OK;
+}
+
+size_t hash_map_size(hash_map_t* self) 
+{
+    return self->used;
+}
+
+size_t hash_map_capacity(hash_map_t* self)
+{
+    return self->allocated;
+}
+
+void hash_map_incremental_resize(hash_map_t* self, bool enabled)
+{
+    if (!enabled)
+    {
+        // dokonceni probihajiciho presunu
+        hash_map_migrate(self, SIZE_MAX);
+    }
+    self->incremental = enabled;
+}
+
+hash_map_item_t* hash_map_next(hash_map_t* self, hash_map_item_t* item)
+{
+    item = item == NULL ? self->first : hash_map_entry_after(self, item);
+    // odstranene zaznamy se preskakuji
+    while (item != NULL && item->key == NULL)
+    {
+        item = hash_map_entry_after(self, item);
+    }
+    return item;
+}
+
+bool hash_map_contains(hash_map_t* self, const char* key)
+{
+    return hash_map_contains_bytes(self, key, strlen(key));
+}
+
+hash_map_state_code_t hash_map_put(hash_map_t* self, const char* key, int value)
+{
+    return hash_map_put_bytes(self, key, strlen(key), value);
+}
+
+hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key, int* dst)
+{
+    return hash_map_get_bytes(self, key, strlen(key), dst);
+}
+
+hash_map_state_code_t hash_map_remove(hash_map_t* self, const char* key)
+{
+    int dst;
+    return hash_map_pop(self, key, &dst);
+}
+
+hash_map_state_code_t hash_map_increment(hash_map_t* self, const char* key, int delta, 
+                                         int* new_value)
+{
+    size_t len = strlen(key);
+    return hash_map_increment_hashed(self, key, len, hash_bytes(key, len, self->seed), 
+                                     delta, new_value);
+}
+
+hash_map_state_code_t hash_map_get_or_insert(hash_map_t* self, const char* key, int value, 
+                                             int** slot)
+{
+    return hash_map_get_or_insert_bytes(self, key, strlen(key), value, slot);
+}
+
+hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key, int* dst)
+{
+    return hash_map_pop_bytes(self, key, strlen(key), dst);
+}
+
+bool hash_map_contains_bytes(hash_map_t* self, const void* key, size_t len)
+{
+    return hash_map_contains_hashed(self, key, len, hash_bytes(key, len, self->seed));
+}
+
+hash_map_state_code_t hash_map_put_bytes(hash_map_t* self, const void* key, size_t len, 
+                                         int value)
+{
+    return hash_map_put_hashed(self, key, len, hash_bytes(key, len, self->seed), value);
+}
+
+hash_map_state_code_t hash_map_get_bytes(hash_map_t* self, const void* key, size_t len, 
+                                         int* dst)
+{
+    return hash_map_get_hashed(self, key, len, hash_bytes(key, len, self->seed), dst);
+}
+
+hash_map_state_code_t hash_map_pop_bytes(hash_map_t* self, const void* key, size_t len, 
+                                         int* dst)
+{
+    return hash_map_pop_hashed(self, key, len, hash_bytes(key, len, self->seed), dst);
+}
+
+hash_map_state_code_t hash_map_remove_bytes(hash_map_t* self, const void* key, size_t len)
+{
+    int dst;
+    return hash_map_pop_bytes(self, key, len, &dst);
+}
+
+hash_map_state_code_t hash_map_get_or_insert_bytes(hash_map_t* self, const void* key, 
+                                                   size_t len, int value, int** slot)
+{
+    hash_map_item_t* item;
+    hash_map_state_code_t state = hash_map_upsert_hashed(self, key, len, 
+                                                         hash_bytes(key, len, self->seed), 
+                                                         value, &item);
+    if (state != MEMORY_ERROR)
+    {
+        *slot = &item->value;
+    }
+    return state;
+}
+
+hash_map_state_code_t hash_map_put_u64(hash_map_t* self, const char* key, uint64_t value)
+{
+    size_t len = strlen(key);
+    hash_map_item_t* item;
+    hash_map_state_code_t state = hash_map_upsert_hashed(self, key, len, 
+                                                         hash_bytes(key, len, self->seed), 
+                                                         0, &item);
+    if (state != MEMORY_ERROR)
+    {
+        item->value_u64 = value;
+    }
+    return state;
+}
+
+hash_map_state_code_t hash_map_get_u64(hash_map_t* self, const char* key, uint64_t* value)
+{
+    size_t len = strlen(key);
+    hash_map_item_t* item = hash_map_use_hashed(self, key, len, hash_bytes(key, len, self->seed));
+    if (item == NULL)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+    *value = item->value_u64;
+    return OK;
+}
+
+hash_map_state_code_t hash_map_put_ptr(hash_map_t* self, const char* key, void* value)
+{
+    size_t len = strlen(key);
+    hash_map_item_t* item;
+    hash_map_state_code_t state = hash_map_upsert_hashed(self, key, len, 
+                                                         hash_bytes(key, len, self->seed), 
+                                                         0, &item);
+    if (state != MEMORY_ERROR)
+    {
+        item->value_ptr = value;
+    }
+    return state;
+}
+
+hash_map_state_code_t hash_map_get_ptr(hash_map_t* self, const char* key, void** value)
+{
+    size_t len = strlen(key);
+    hash_map_item_t* item = hash_map_use_hashed(self, key, len, hash_bytes(key, len, self->seed));
+    if (item == NULL)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+    *value = item->value_ptr;
+    return OK;
+}
+
+hash_map_state_code_t hash_map_put_value(hash_map_t* self, const char* key, const void* value)
+{
+    if (self->value_size == 0)
+    {
+        // tabulka nema hodnoty pevne velikosti
+        return VALUE_ERROR;
+    }
+
+    size_t len = strlen(key);
+    hash_map_item_t* item;
+    hash_map_state_code_t state = hash_map_upsert_hashed(self, key, len, 
+                                                         hash_bytes(key, len, self->seed), 
+                                                         0, &item);
+    if (state != MEMORY_ERROR)
+    {
+        memcpy(item->key + hash_map_value_offset(len), value, self->value_size);
+    }
+    return state;
+}
+
+void* hash_map_get_value(hash_map_t* self, const char* key)
+{
+    if (self->value_size == 0)
+    {
+        return NULL;
+    }
+
+    size_t len = strlen(key);
+    hash_map_item_t* item = hash_map_use_hashed(self, key, len, hash_bytes(key, len, self->seed));
+    return item != NULL ? item->key + hash_map_value_offset(len) : NULL;
+}
+
+size_t hash_map_get_many(hash_map_t* self, const char* const* keys, size_t count, 
+                         int* values, hash_map_state_code_t* states)
+{
+    size_t hashes[HASH_MAP_BATCH_SIZE];
+    size_t lengths[HASH_MAP_BATCH_SIZE];
+    const hash_map_item_t* items[HASH_MAP_BATCH_SIZE];
+    size_t found = 0;
+
+    for (size_t start = 0; start < count; start += HASH_MAP_BATCH_SIZE)
+    {
+        size_t batch = count - start < HASH_MAP_BATCH_SIZE ? count - start : HASH_MAP_BATCH_SIZE;
+
+        // hase cele davky a nacteni jejich skupin indexu
+        for (size_t i = 0; i < batch; ++i)
+        {
+            lengths[i] = strlen(keys[start + i]);
+            hashes[i] = hash_bytes(keys[start + i], lengths[i], self->seed);
+            hash_map_prefetch_group(self, hashes[i]);
+        }
+        // nacteni kandidatnich polozek
+        for (size_t i = 0; i < batch; ++i)
+        {
+            items[i] = hash_map_prefetch_item(self, hashes[i]);
+        }
+        // nacteni jejich klicu
+        for (size_t i = 0; i < batch; ++i)
+        {
+            hash_map_prefetch_key(items[i]);
+        }
+        // dokonceni vyhledavani
+        for (size_t i = 0; i < batch; ++i)
+        {
+            hash_map_state_code_t state = hash_map_get_hashed(self, keys[start + i], lengths[i], 
+                                                              hashes[i], values + start + i);
+            found += state == OK;
+            if (states != NULL)
+            {
+                states[start + i] = state;
+            }
+        }
+    }
+
+    return found;
+}
+
+hash_map_state_code_t hash_map_put_many(hash_map_t* self, const char* const* keys, 
+                                        const int* values, size_t count, 
+                                        hash_map_state_code_t* states)
+{
+    size_t hashes[HASH_MAP_BATCH_SIZE];
+    size_t lengths[HASH_MAP_BATCH_SIZE];
+    const hash_map_item_t* items[HASH_MAP_BATCH_SIZE];
+    hash_map_state_code_t result = OK;
+
+    for (size_t start = 0; start < count; start += HASH_MAP_BATCH_SIZE)
+    {
+        size_t batch = count - start < HASH_MAP_BATCH_SIZE ? count - start : HASH_MAP_BATCH_SIZE;
+
+        // realokace behem davky nactena mista zneplatni, jde ale jen o napovedu
+        for (size_t i = 0; i < batch; ++i)
+        {
+            lengths[i] = strlen(keys[start + i]);
+            hashes[i] = hash_bytes(keys[start + i], lengths[i], self->seed);
+            hash_map_prefetch_group(self, hashes[i]);
+        }
+        for (size_t i = 0; i < batch; ++i)
+        {
+            items[i] = hash_map_prefetch_item(self, hashes[i]);
+        }
+        for (size_t i = 0; i < batch; ++i)
+        {
+            hash_map_prefetch_key(items[i]);
+        }
+        for (size_t i = 0; i < batch; ++i)
+        {
+            hash_map_state_code_t state = hash_map_put_hashed(self, keys[start + i], lengths[i], 
+                                                              hashes[i], values[start + i]);
+            if (state == MEMORY_ERROR)
+            {
+                result = MEMORY_ERROR;
+            }
+            if (states != NULL)
+            {
+                states[start + i] = state;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+ * Souběžná hašovací tabulka.
+ ******************************************************************************/
+/**
+ * @brief Oddíl souběžné tabulky, do kterého patří zadaný haš.
+ *
+ * @param[in] self Ukazatel na souběžnou hašovací tabulku.
+ * @param[in] hash Haš klíče.
+ * 
+ * @return Ukazatel na oddíl určený horními bity haše.
+ */
+static inline hash_map_shard_t* hash_map_concurrent_shard(hash_map_concurrent_t* self, 
+                                                          size_t hash)
+{
+    if (self->shard_bits == 0)
+    {
+        return self->shards;
+    }
+    return self->shards + (hash >> (sizeof(size_t)*8 - self->shard_bits));
+}
+
+hash_map_concurrent_t* hash_map_concurrent_ctor(size_t shards)
+{
+    if (shards == 0 || shards > ((size_t)1 << (sizeof(size_t)*8 - 2)))
+    {
+        return NULL;
+    }
+
+    hash_map_concurrent_t* self = (hash_map_concurrent_t*)malloc(sizeof(hash_map_concurrent_t));
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    // zaokrouhleni na mocninu dvou
+    self->shard_bits = 0;
+    while (((size_t)1 << self->shard_bits) < shards)
+    {
+        self->shard_bits++;
+    }
+    self->shard_count = (size_t)1 << self->shard_bits;
+    self->seed = HASH_FUNCTION_SEED;
+    self->shards = (hash_map_shard_t*)aligned_alloc(HASH_MAP_CACHE_LINE, 
+                                                    self->shard_count*sizeof(hash_map_shard_t));
+    if (self->shards == NULL)
+    {
+        free(self);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < self->shard_count; ++i)
+    {
+        self->shards[i].map = hash_map_ctor();
+        if (self->shards[i].map == NULL)
+        {
+            // uklid jiz vytvorenych oddilu
+            self->shard_count = i;
+            hash_map_concurrent_dtor(self);
+            return NULL;
+        }
+        // zapis nikdy neceka na prestavbu celeho indexu oddilu
+        hash_map_incremental_resize(self->shards[i].map, true);
+        // citaci by pri hledani zapisovali do sdilene tabulky
+        self->shards[i].map->count_probes = false;
+        pthread_rwlock_init(&self->shards[i].lock, NULL);
+    }
+
+    return self;
+}
+
+void hash_map_concurrent_dtor(hash_map_concurrent_t* self)
+{
+    for (size_t i = 0; i < self->shard_count; ++i)
+    {
+        pthread_rwlock_destroy(&self->shards[i].lock);
+        hash_map_dtor(self->shards[i].map);
+    }
+    free(self->shards);
+    free(self);
+}
+
+void hash_map_concurrent_clear(hash_map_concurrent_t* self)
+{
+    for (size_t i = 0; i < self->shard_count; ++i)
+    {
+        pthread_rwlock_wrlock(&self->shards[i].lock);
+        hash_map_clear(self->shards[i].map);
+        pthread_rwlock_unlock(&self->shards[i].lock);
+    }
+}
+
+size_t hash_map_concurrent_size(hash_map_concurrent_t* self)
+{
+    size_t size = 0;
+    for (size_t i = 0; i < self->shard_count; ++i)
+    {
+        pthread_rwlock_rdlock(&self->shards[i].lock);
+        size += hash_map_size(self->shards[i].map);
+        pthread_rwlock_unlock(&self->shards[i].lock);
+    }
+    return size;
+}
+
+bool hash_map_concurrent_contains(hash_map_concurrent_t* self, const char* key)
+{
+    size_t len = strlen(key);
+    size_t hash = hash_bytes(key, len, self->seed);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+
+    // hledani tabulku nemeni, ctenari mohou sdilet zamek
+    pthread_rwlock_rdlock(&shard->lock);
+    bool found = hash_map_contains_hashed(shard->map, key, len, hash);
+    pthread_rwlock_unlock(&shard->lock);
+    return found;
+}
+
+hash_map_state_code_t hash_map_concurrent_put(hash_map_concurrent_t* self, 
+                                              const char* key, int value)
+{
+    size_t len = strlen(key);
+    size_t hash = hash_bytes(key, len, self->seed);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    hash_map_state_code_t state = hash_map_put_hashed(shard->map, key, len, hash, value);
+    pthread_rwlock_unlock(&shard->lock);
+    return state;
+}
+
+hash_map_state_code_t hash_map_concurrent_get(hash_map_concurrent_t* self, 
+                                              const char* key, int* value)
+{
+    size_t len = strlen(key);
+    size_t hash = hash_bytes(key, len, self->seed);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+
+    pthread_rwlock_rdlock(&shard->lock);
+    hash_map_state_code_t state = hash_map_get_hashed(shard->map, key, len, hash, value);
+    pthread_rwlock_unlock(&shard->lock);
+    return state;
+}
+
+hash_map_state_code_t hash_map_concurrent_pop(hash_map_concurrent_t* self, 
+                                              const char* key, int* value)
+{
+    size_t len = strlen(key);
+    size_t hash = hash_bytes(key, len, self->seed);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+
+    pthread_rwlock_wrlock(&shard->lock);
+    hash_map_state_code_t state = hash_map_pop_hashed(shard->map, key, len, hash, value);
+    pthread_rwlock_unlock(&shard->lock);
+    return state;
+}
+
+hash_map_state_code_t hash_map_concurrent_increment(hash_map_concurrent_t* self, 
+                                                    const char* key, int delta, 
+                                                    int* new_value)
+{
+    size_t len = strlen(key);
+    size_t hash = hash_bytes(key, len, self->seed);
+    hash_map_shard_t* shard = hash_map_concurrent_shard(self, hash);
+
+    // cteni i zapis hodnoty probehnou pod jednim zamkem
+    pthread_rwlock_wrlock(&shard->lock);
+    hash_map_state_code_t state = hash_map_increment_hashed(shard->map, key, len, hash, 
+                                                            delta, new_value);
+    pthread_rwlock_unlock(&shard->lock);
+    return state;
+}
+
+hash_map_state_code_t hash_map_concurrent_remove(hash_map_concurrent_t* self, 
+                                                 const char* key)
+{
+    int value;
+    return hash_map_concurrent_pop(self, key, &value);
+}
+
+/*******************************************************************************
+ * Zmrazená hašovací tabulka.
+ ******************************************************************************/
+/**
+ * @brief Pozice záznamu ve zmrazené tabulce.
+ *
+ * @param[in] hash  Haš klíče.
+ * @param[in] pilot Pilot skupiny klíče.
+ * @param[in] count Počet záznamů zmrazené tabulky.
+ * 
+ * @return Index záznamu.
+ */
+static inline size_t hash_map_frozen_position(size_t hash, uint32_t pilot, size_t count)
+{
+    return hash_mix(hash ^ hash_secret[2], ((uint64_t)pilot + 1)*hash_secret[3]) % count;
+}
+
+/**
+ * @brief Nalezení záznamu ve zmrazené tabulce.
+ *
+ * @param[in] self Ukazatel na zmrazenou tabulku.
+ * @param[in] key  Klíč.
+ * @param[in] len  Délka klíče v bajtech.
+ * 
+ * @return Ukazatel na záznam, nebo @c NULL pokud záznam neexistuje.
+ */
+static const hash_map_frozen_slot_t* hash_map_frozen_find(const hash_map_frozen_t* self, 
+                                                          const void* key, size_t len)
+{
+    if (self->count == 0)
+    {
+        return NULL;
+    }
+
+    size_t hash = hash_bytes(key, len, self->seed);
+    uint32_t pilot = self->pilots[hash % self->buckets];
+    const hash_map_frozen_slot_t* slot = self->slots + 
+                                         hash_map_frozen_position(hash, pilot, self->count);
+    // pozice je urcena vzdy, klic se proto musi porovnat; zaznam 
+    // namapovaneho souboru muze ukazovat mimo pole klicu
+    if (slot->key_len != len || len > self->key_bytes || 
+        slot->key_offset > self->key_bytes - len || 
+        memcmp(self->keys + slot->key_offset, key, len) != 0)
+    {
+        return NULL;
+    }
+    return slot;
+}
+
+/**
+ * @brief Nalezení pilota, se kterým všechny klíče skupiny padnou na volné 
+ *        a navzájem různé pozice.
+ *
+ * @param[in]     members   Záznamy skupiny.
+ * @param[in]     size      Počet záznamů skupiny.
+ * @param[in]     count     Počet záznamů zmrazené tabulky.
+ * @param[in]     taken     Bitová mapa obsazených pozic.
+ * @param[out]    positions Nalezené pozice záznamů skupiny.
+ * @param[out]    pilot     Nalezený pilot.
+ * 
+ * @return @c true pokud byl pilot nalezen.
+ */
+static bool hash_map_frozen_pilot(hash_map_item_t* const* members, size_t size, size_t count, 
+                                  const uint64_t* taken, size_t* positions, uint32_t* pilot)
+{
+    // klice se shodnym hasem by pri kazdem pilotovi padly na stejnou pozici
+    for (size_t i = 0; i < size; ++i)
+    {
+        for (size_t j = i + 1; j < size; ++j)
+        {
+            if (members[i]->hash == members[j]->hash)
+            {
+                return false;
+            }
+        }
+    }
+
+    for (uint64_t candidate = 0; candidate <= UINT32_MAX; ++candidate)
+    {
+        size_t placed = 0;
+        for (; placed < size; ++placed)
+        {
+            size_t position = hash_map_frozen_position(members[placed]->hash, 
+                                                       (uint32_t)candidate, count);
+            if (taken[position / 64] & ((uint64_t)1 << (position % 64)))
+            {
+                break;
+            }
+            size_t j = 0;
+            while (j < placed && positions[j] != position)
+            {
+                j++;
+            }
+            if (j < placed)
+            {
+                break;
+            }
+            positions[placed] = position;
+        }
+        if (placed == size)
+        {
+            *pilot = (uint32_t)candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Začátek pole hodnot pevné velikosti zmrazené tabulky.
+ *
+ * Hodnoty následují za piloty zarovnané na 8 bajtů, v souboru i v paměti.
+ *
+ * @param[in] count   Počet záznamů.
+ * @param[in] buckets Počet skupin klíčů.
+ *
+ * @return Offset pole hodnot od začátku oblasti se záznamy.
+ */
+static inline size_t hash_map_frozen_values_offset(size_t count, size_t buckets)
+{
+    return (count*sizeof(hash_map_frozen_slot_t) + buckets*sizeof(uint32_t) + 7) & ~(size_t)7;
+}
+
+/**
+ * @brief Rozmístění záznamů, pilotů, hodnot a klíčů zmrazené tabulky za sebou.
+ *
+ * @param[in,out] self Zmrazená tabulka s nastaveným počtem záznamů, skupin 
+ *                     a velikostí hodnot.
+ * @param[in]     data Začátek oblasti se záznamy.
+ */
+static void hash_map_frozen_layout(hash_map_frozen_t* self, char* data)
+{
+    self->slots = (hash_map_frozen_slot_t*)data;
+    self->pilots = (uint32_t*)(self->slots + self->count);
+    self->values = data + hash_map_frozen_values_offset(self->count, self->buckets);
+    self->keys = self->values + self->count*self->value_size;
+}
+
+hash_map_frozen_t* hash_map_freeze(hash_map_t* self)
+{
+    size_t count = self->used;
+    size_t buckets = count / HASH_MAP_FROZEN_BUCKET_SIZE + 1;
+    size_t key_bytes = 0;
+    for (hash_map_item_t* item = hash_map_next(self, NULL); item != NULL; 
+         item = hash_map_next(self, item))
+    {
+        key_bytes += item->key_len;
+    }
+    if (key_bytes > UINT32_MAX)
+    {
+        return NULL;
+    }
+
+    // struktura, zaznamy, piloti, hodnoty a klice v jednom bloku
+    size_t header = (sizeof(hash_map_frozen_t) + 15) & ~(size_t)15;
+    size_t size = header + hash_map_frozen_values_offset(count, buckets) + 
+                  count*self->value_size + key_bytes;
+    hash_map_frozen_t* frozen = (hash_map_frozen_t*)hash_map_alloc(self, size);
+
+    // pomocna pole: zaznamy serazene podle skupin, zacatky skupin, poradi 
+    // skupin od nejvetsi, obsazene pozice a pozice zpracovavane skupiny
+    size_t words = count / 64 + 1;
+    size_t members_size = (count + 1)*sizeof(hash_map_item_t*);
+    hash_map_item_t** members = (hash_map_item_t**)hash_map_alloc(self, members_size);
+    size_t* starts = (size_t*)hash_map_alloc(self, (buckets + 1)*sizeof(size_t));
+    size_t* order = (size_t*)hash_map_alloc(self, buckets*sizeof(size_t));
+    size_t* sizes = (size_t*)hash_map_alloc(self, (count + 2)*sizeof(size_t));
+    uint64_t* taken = (uint64_t*)hash_map_alloc(self, words*sizeof(uint64_t));
+    size_t* positions = (size_t*)hash_map_alloc(self, (count + 1)*sizeof(size_t));
+    bool success = frozen != NULL && members != NULL && starts != NULL && order != NULL && 
+                   sizes != NULL && taken != NULL && positions != NULL;
 
-    if (self->index[idx] == NULL)
+    if (success)
+    {
+        frozen->count = count;
+        frozen->buckets = buckets;
+        frozen->seed = self->seed;
+        frozen->value_size = self->value_size;
+        hash_map_frozen_layout(frozen, (char*)frozen + header);
+        frozen->key_bytes = key_bytes;
+        frozen->size = size;
+        frozen->allocator = self->allocator;
+        frozen->mapping = NULL;
+        frozen->mapping_size = 0;
+        memset(frozen->pilots, 0, buckets*sizeof(uint32_t));
+        memset(taken, 0, words*sizeof(uint64_t));
+
+        // rozdeleni zaznamu do skupin (razeni pocitanim)
+        memset(starts, 0, (buckets + 1)*sizeof(size_t));
+        for (hash_map_item_t* item = hash_map_next(self, NULL); item != NULL; 
+             item = hash_map_next(self, item))
+        {
+            starts[item->hash % buckets + 1]++;
+        }
+        for (size_t b = 0; b < buckets; ++b)
+        {
+            starts[b + 1] += starts[b];
+        }
+        for (hash_map_item_t* item = hash_map_next(self, NULL); item != NULL; 
+             item = hash_map_next(self, item))
+        {
+            members[starts[item->hash % buckets]++] = item;
+        }
+        for (size_t b = buckets; b > 0; --b)
+        {
+            starts[b] = starts[b - 1];
+        }
+        starts[0] = 0;
+
+        // skupiny od nejvetsi, velke skupiny se umistuji do prazdne tabulky
+        memset(sizes, 0, (count + 2)*sizeof(size_t));
+        for (size_t b = 0; b < buckets; ++b)
+        {
+            sizes[count - (starts[b + 1] - starts[b]) + 1]++;
+        }
+        for (size_t s = 0; s <= count; ++s)
+        {
+            sizes[s + 1] += sizes[s];
+        }
+        for (size_t b = 0; b < buckets; ++b)
+        {
+            order[sizes[count - (starts[b + 1] - starts[b])]++] = b;
+        }
+
+        size_t key_offset = 0;
+        for (size_t i = 0; i < buckets && success; ++i)
+        {
+            size_t b = order[i];
+            size_t bucket_size = starts[b + 1] - starts[b];
+            if (bucket_size == 0)
+            {
+                // prazdne skupiny jsou razeny na konec
+                break;
+            }
+            success = hash_map_frozen_pilot(members + starts[b], bucket_size, count, taken, 
+                                            positions, &frozen->pilots[b]);
+            for (size_t j = 0; j < bucket_size && success; ++j)
+            {
+                hash_map_item_t* item = members[starts[b] + j];
+                hash_map_frozen_slot_t* slot = frozen->slots + positions[j];
+                taken[positions[j] / 64] |= (uint64_t)1 << (positions[j] % 64);
+                slot->value_u64 = item->value_u64;
+                slot->key_offset = (uint32_t)key_offset;
+                slot->key_len = (uint32_t)item->key_len;
+                memcpy(frozen->keys + key_offset, item->key, item->key_len);
+                key_offset += item->key_len;
+                // hodnota pevne velikosti lezi v tabulce za klicem
+                memcpy(frozen->values + positions[j]*frozen->value_size, 
+                       item->key + hash_map_value_offset(item->key_len), frozen->value_size);
+            }
+        }
+    }
+
+    hash_map_release(self, members, members_size);
+    hash_map_release(self, starts, (buckets + 1)*sizeof(size_t));
+    hash_map_release(self, order, buckets*sizeof(size_t));
+    hash_map_release(self, sizes, (count + 2)*sizeof(size_t));
+    hash_map_release(self, taken, words*sizeof(uint64_t));
+    hash_map_release(self, positions, (count + 1)*sizeof(size_t));
+    if (!success)
+    {
+        hash_map_release(self, frozen, size);
+        return NULL;
+    }
+    return frozen;
+}
+
+void hash_map_frozen_dtor(hash_map_frozen_t* self)
+{
+    if (self->mapping != NULL)
+    {
+        munmap(self->mapping, self->mapping_size);
+    }
+    hash_map_allocator_t allocator = self->allocator;
+    allocator.release(allocator.ctx, self, self->size);
+}
+
+size_t hash_map_frozen_size(const hash_map_frozen_t* self)
+{
+    return self->count;
+}
+
+bool hash_map_frozen_contains(const hash_map_frozen_t* self, const char* key)
+{
+    return hash_map_frozen_find(self, key, strlen(key)) != NULL;
+}
+
+hash_map_state_code_t hash_map_frozen_get(const hash_map_frozen_t* self, const char* key, 
+                                          int* value)
+{
+    return hash_map_frozen_get_bytes(self, key, strlen(key), value);
+}
+
+hash_map_state_code_t hash_map_frozen_get_bytes(const hash_map_frozen_t* self, 
+                                                const void* key, size_t len, int* value)
+{
+    const hash_map_frozen_slot_t* slot = hash_map_frozen_find(self, key, len);
+    if (slot == NULL)
     {
         // klic neni asociovan se zadnym zaznamem
         return KEY_ERROR;
     }
-    else 
+    *value = slot->value;
+    return OK;
+}
+
+hash_map_state_code_t hash_map_frozen_get_u64(const hash_map_frozen_t* self, const char* key, 
+                                              uint64_t* value)
+{
+    const hash_map_frozen_slot_t* slot = hash_map_frozen_find(self, key, strlen(key));
+    if (slot == NULL)
     {
-        // jedna se o prvni zaznam v seznamu?
-        if (self->index[idx]->prev == NULL)
-        {
-            self->first = self->index[idx]->next;
-        }
-        else 
+        return KEY_ERROR;
+    }
+    *value = slot->value_u64;
+    return OK;
+}
+
+const void* hash_map_frozen_get_value(const hash_map_frozen_t* self, const char* key)
+{
+    if (self->value_size == 0)
+    {
+        return NULL;
+    }
+
+    const hash_map_frozen_slot_t* slot = hash_map_frozen_find(self, key, strlen(key));
+    return slot != NULL ? self->values + (slot - self->slots)*self->value_size : NULL;
+}
+
+/*******************************************************************************
+ * Uložení zmrazené tabulky do souboru.
+ ******************************************************************************/
+/** Značka na začátku souboru se zmrazenou tabulkou. */
+static const char hash_map_image_magic[8] = {'H', 'A', 'S', 'H', 'M', 'A', 'P', '\0'};
+
+/**
+ * @brief Hlavička souboru se zmrazenou tabulkou.
+ *
+ * Za hlavičkou (72 bajtů) následují záznamy, piloti, hodnoty a klíče ve 
+ * stejném rozložení jako v paměti zmrazené tabulky.
+ */
+typedef struct hash_map_image_header
+{
+    char magic[8];          ///< Značka formátu
+    uint32_t version;       ///< Verze formátu
+    uint32_t byte_order;    ///< Hodnota 0x01020304 v pořadí bajtů zapisovatele
+    uint32_t word_size;     ///< Velikost typu @c size_t zapisovatele
+    uint32_t slot_size;     ///< Velikost záznamu
+    uint64_t count;         ///< Počet záznamů
+    uint64_t buckets;       ///< Počet skupin klíčů
+    uint64_t seed;          ///< Semínko hašovací funkce
+    uint64_t data_size;     ///< Velikost záznamů, pilotů, hodnot a klíčů
+    uint64_t hash_check;    ///< Haš značky, odhalí jinou hašovací funkci
+    uint64_t value_size;    ///< Velikost hodnoty pevné velikosti, nebo 0
+} hash_map_image_header_t;
+
+hash_map_state_code_t hash_map_save(hash_map_t* self, const char* path)
+{
+    hash_map_frozen_t* frozen = hash_map_freeze(self);
+    if (frozen == NULL)
+    {
+        return MEMORY_ERROR;
+    }
+
+    hash_map_image_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, hash_map_image_magic, sizeof(header.magic));
+    header.version = HASH_MAP_IMAGE_VERSION;
+    header.byte_order = 0x01020304;
+    header.word_size = sizeof(size_t);
+    header.slot_size = sizeof(hash_map_frozen_slot_t);
+    header.count = frozen->count;
+    header.buckets = frozen->buckets;
+    header.seed = frozen->seed;
+    header.value_size = frozen->value_size;
+    header.data_size = frozen->size - ((char*)frozen->slots - (char*)frozen);
+    header.hash_check = hash_bytes(hash_map_image_magic, sizeof(hash_map_image_magic), 
+                                   frozen->seed);
+
+    // zapis vedle ciloveho souboru, prejmenovani je atomicke
+    size_t path_len = strlen(path);
+    char* tmp_path = (char*)malloc(path_len + sizeof(".tmp"));
+    if (tmp_path == NULL)
+    {
+        hash_map_frozen_dtor(frozen);
+        return MEMORY_ERROR;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", sizeof(".tmp"));
+
+    hash_map_state_code_t state = IO_ERROR;
+    FILE* file = fopen(tmp_path, "wb");
+    if (file != NULL)
+    {
+        bool written = fwrite(&header, sizeof(header), 1, file) == 1 && 
+                       fwrite(frozen->slots, 1, header.data_size, file) == header.data_size;
+        if (fclose(file) == 0 && written && rename(tmp_path, path) == 0)
         {
-            self->index[idx]->prev->next = self->index[idx]->next;
+            state = OK;
         }
-        // jedna se o posledni zaznam v seznamu?
-        if (self->index[idx]->next == NULL)
+        else
         {
-            self->last = self->index[idx]->prev;
+            remove(tmp_path);
         }
-        else 
+    }
+
+    free(tmp_path);
+    hash_map_frozen_dtor(frozen);
+    return state;
+}
+
+hash_map_frozen_t* hash_map_open_mmap(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (uint64_t)info.st_size < sizeof(hash_map_image_header_t))
+    {
+        close(fd);
+        return NULL;
+    }
+    size_t file_size = (size_t)info.st_size;
+    void* mapping = mmap(NULL, file_size, PROT_READ, MAP_SHARED, fd, 0);
+    // mapovani zustava platne i po zavreni souboru
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    // kontrola hlavicky, zaznamy se nectou
+    const hash_map_image_header_t* header = (const hash_map_image_header_t*)mapping;
+    uint64_t data_size = file_size - sizeof(hash_map_image_header_t);
+    bool valid = memcmp(header->magic, hash_map_image_magic, sizeof(header->magic)) == 0 && 
+                 header->version == HASH_MAP_IMAGE_VERSION && 
+                 header->byte_order == 0x01020304 && 
+                 header->word_size == sizeof(size_t) && 
+                 header->slot_size == sizeof(hash_map_frozen_slot_t) && 
+                 header->data_size == data_size && 
+                 header->buckets > 0 && 
+                 header->count <= data_size / sizeof(hash_map_frozen_slot_t) && 
+                 header->buckets <= (data_size - header->count*sizeof(hash_map_frozen_slot_t)) / 
+                                    sizeof(uint32_t) && 
+                 hash_map_frozen_values_offset(header->count, header->buckets) <= data_size && 
+                 (header->count == 0 || 
+                  header->value_size <= (data_size - hash_map_frozen_values_offset(
+                                         header->count, header->buckets)) / header->count) && 
+                 header->hash_check == hash_bytes(hash_map_image_magic, 
+                                                  sizeof(hash_map_image_magic), header->seed);
+    hash_map_frozen_t* self = valid ? (hash_map_frozen_t*)malloc(sizeof(hash_map_frozen_t)) 
+                                    : NULL;
+    if (self == NULL)
+    {
+        munmap(mapping, file_size);
+        return NULL;
+    }
+
+    self->count = header->count;
+    self->buckets = header->buckets;
+    self->seed = header->seed;
+    self->value_size = header->value_size;
+    hash_map_frozen_layout(self, (char*)mapping + sizeof(hash_map_image_header_t));
+    self->key_bytes = data_size - hash_map_frozen_values_offset(self->count, self->buckets) - 
+                      self->count*self->value_size;
+    self->size = sizeof(hash_map_frozen_t);
+    self->allocator = hash_map_default_allocator;
+    self->mapping = mapping;
+    self->mapping_size = file_size;
+    return self;
+}
+
+/*******************************************************************************
+ * Statistiky.
+ ******************************************************************************/
+void hash_map_stats(hash_map_t* self, hash_map_stats_t* stats)
+{
+    stats->live = self->used;
+    stats->tombstones = self->deleted;
+    // behem presunu se nepresunute zaznamy pocitaji misto vyhrazeneho mista
+    size_t entries = self->old_index != NULL ? 
+                     self->entries_used - self->entries_base + self->copied + 
+                     self->old_entries_used - self->migrated : self->entries_used;
+    stats->dead_entries = entries - self->used;
+    stats->capacity = self->allocated;
+    stats->load_factor = self->allocated > 0 ? (double)self->used / self->allocated : 0.0;
+    memcpy(stats->probe_hits, self->counters.probe_hits, sizeof(stats->probe_hits));
+    memcpy(stats->probe_misses, self->counters.probe_misses, sizeof(stats->probe_misses));
+    stats->resizes = self->counters.resizes;
+    stats->rehash_ns = self->counters.rehash_ns;
+
+    stats->item_bytes = self->entries_allocated*sizeof(hash_map_item_t);
+    stats->index_bytes = self->allocated*self->index_width + 
+                         hash_map_groups(self->allocated)*HASH_MAP_GROUP_WIDTH;
+    if (self->old_index != NULL)
+    {
+        stats->item_bytes += self->old_entries_allocated*sizeof(hash_map_item_t);
+        stats->index_bytes += self->old_allocated*self->old_width + 
+                              hash_map_groups(self->old_allocated)*HASH_MAP_GROUP_WIDTH;
+    }
+    // bloky klicu podle velikosti, se kterou byly prideleny
+    stats->key_bytes = self->slab.used_bytes;
+}
+
+void hash_map_stats_reset(hash_map_t* self)
+{
+    memset(&self->counters, 0, sizeof(self->counters));
+}
+
+/*******************************************************************************
+ * Tabulka s celočíselnými klíči.
+ ******************************************************************************/
+/**
+ * @brief Haš celočíselného klíče.
+ *
+ * Klíč se promíchá jediným 128bitovým násobením, takže i klíče lišící se jen 
+ * v horních bitech padnou do různých skupin.
+ *
+ * @param[in] self Ukazatel na tabulku.
+ * @param[in] key  Klíč.
+ *
+ * @return Haš klíče.
+ */
+static inline size_t hash_map_u64_hash(const hash_map_u64_t* self, uint64_t key)
+{
+    return hash_mix(key ^ self->seed, hash_secret[1]);
+}
+
+/**
+ * @brief Kontext hledání v tabulce s celočíselnými klíči.
+ */
+typedef struct hash_map_u64_match
+{
+    const hash_map_u64_slot_t* slots; ///< Záznamy tabulky
+    uint64_t key;                     ///< Hledaný klíč
+} hash_map_u64_match_t;
+
+/**
+ * @brief Porovnání klíče na místě indexu (viz @c hash_map_ctrl_match_t ).
+ */
+static inline bool hash_map_u64_match(const void* ctx, size_t idx)
+{
+    const hash_map_u64_match_t* match = (const hash_map_u64_match_t*)ctx;
+    return match->slots[idx].key == match->key;
+}
+
+/**
+ * @brief Hledání klíče v indexu tabulky s celočíselnými klíči.
+ *
+ * Prochází skupiny pomocí @c hash_map_ctrl_probe , klíč se porovná přímo 
+ * na místě indexu.
+ *
+ * @param[in]  self  Ukazatel na tabulku.
+ * @param[in]  key   Klíč.
+ * @param[in]  hash  Haš klíče.
+ * @param[out] found Nastaveno na @c true , pokud byl klíč nalezen.
+ *
+ * @return Místo klíče, nebo první volné místo na cestě. Pokud klíč chybí 
+ *         a index nemá volné místo, vrací @c HASH_MAP_NOT_FOUND .
+ */
+static size_t hash_map_u64_probe(const hash_map_u64_t* self, uint64_t key, size_t hash,
+                                 bool* found)
+{
+    hash_map_u64_match_t match = { self->slots, key };
+    size_t length;
+    return hash_map_ctrl_probe(self->ctrl, self->allocated, hash, hash_map_u64_match, &match,
+                               found, &length);
+}
+
+/**
+ * @brief Uvolnění indexu tabulky s celočíselnými klíči.
+ *
+ * Místa i řídicí bajty indexu alokuje @c malloc .
+ *
+ * @param[in] self Ukazatel na tabulku.
+ */
+static void hash_map_u64_release(hash_map_u64_t* self)
+{
+    free(self->slots);
+    free(self->ctrl);
+}
+
+/**
+ * @brief Přestavba indexu tabulky s celočíselnými klíči.
+ *
+ * @param[in] self Ukazatel na tabulku.
+ * @param[in] size Velikost nového indexu, alespoň počet vložených záznamů.
+ *
+ * @return @c MEMORY_ERROR v případě chyby v alokaci paměti, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_u64_rehash(hash_map_u64_t* self, size_t size)
+{
+    if (size > SIZE_MAX / sizeof(hash_map_u64_slot_t) - HASH_MAP_GROUP_WIDTH)
+    {
+        return MEMORY_ERROR;
+    }
+
+    size_t ctrl_size = hash_map_groups(size)*HASH_MAP_GROUP_WIDTH;
+    hash_map_u64_slot_t* slots = (hash_map_u64_slot_t*)malloc(size*sizeof(hash_map_u64_slot_t));
+    uint8_t* ctrl = (uint8_t*)malloc(ctrl_size);
+    if ((slots == NULL && size != 0) || (ctrl == NULL && ctrl_size != 0))
+    {
+        free(slots);
+        free(ctrl);
+        return MEMORY_ERROR;
+    }
+    hash_map_ctrl_init(ctrl, size);
+
+    hash_map_u64_t rebuilt = *self;
+    rebuilt.slots = slots;
+    rebuilt.ctrl = ctrl;
+    rebuilt.allocated = size;
+    rebuilt.deleted = 0;
+
+    // klice jsou ruzne, staci prvni volne misto podle hase
+    for (size_t i = 0; i < self->allocated; ++i)
+    {
+        if (self->ctrl[i] & HASH_MAP_CTRL_EMPTY)
         {
-            self->index[idx]->next->prev = self->index[idx]->prev;
+            continue;
         }
-        // uloz hodnotu
-        *dst = self->index[idx]->value;
-        // smaz zaznam
-        free(self->index[idx]->key);
-        free(self->index[idx]);
-        // Nahrazeni zaznamu za dummy objekt.
-        // V pripade kolize, odstraneni prvne vlozeneho zaznamu s kolizi,
-        // a nastaveni daneho mista na NULL, algoritmus by nemel informaci, 
-        // zda ke kolizi doslo.
-        self->index[idx] = self->dummy;
+        size_t hash = hash_map_u64_hash(self, self->slots[i].key);
+        size_t idx = hash_map_ctrl_free_slot(ctrl, size, hash);
+        hash_map_ctrl_fill(ctrl, idx, hash);
+        slots[idx] = self->slots[i];
+    }
+
+    hash_map_u64_release(self);
+    *self = rebuilt;
+    return OK;
+}
+
+/**
+ * @brief Nalezení záznamu s daným klíčem, případně jeho vložení.
+ *
+ * @param[in]  self  Ukazatel na tabulku.
+ * @param[in]  key   Klíč.
+ * @param[in]  value Hodnota nově vloženého záznamu.
+ * @param[out] slot  Nalezený nebo vložený záznam.
+ *
+ * @return @c KEY_ALREADY_EXISTS pokud záznam existoval, @c MEMORY_ERROR pokud
+ *         se jej nepodařilo vložit, jinak @c OK.
+ */
+static hash_map_state_code_t hash_map_u64_upsert(hash_map_u64_t* self, uint64_t key, int value, 
+                                                 hash_map_u64_slot_t** slot)
+{
+    // stejna pravidla realokace jako hash_map_upsert_hashed
+    if (self->allocated == 0)
+    {
+        hash_map_u64_rehash(self, HASH_MAP_INIT_SIZE);
+    }
+    else if (hash_map_needs_resize(self->used, self->deleted, self->allocated))
+    {
+        hash_map_u64_rehash(self, hash_map_grow_size(self->used, self->allocated));
+    }
+
+    bool found;
+    size_t hash = hash_map_u64_hash(self, key);
+    size_t idx = hash_map_u64_probe(self, key, hash, &found);
+    if (found)
+    {
+        *slot = self->slots + idx;
+        return KEY_ALREADY_EXISTS;
+    }
+    if (idx == HASH_MAP_NOT_FOUND)
+    {
+        // index se nepodarilo zvetsit a je zaplneny
+        return MEMORY_ERROR;
+    }
+
+    self->deleted -= hash_map_ctrl_fill(self->ctrl, idx, hash);
+    self->slots[idx].key = key;
+    self->slots[idx].value = value;
+    self->used++;
+    *slot = self->slots + idx;
+    return OK;
+}
+
+hash_map_u64_t* hash_map_u64_ctor()
+{
+    hash_map_u64_t* self = (hash_map_u64_t*)malloc(sizeof(hash_map_u64_t));
+    if (self == NULL)
+    {
+        return NULL;
+    }
+    self->slots = NULL;
+    self->ctrl = NULL;
+    self->allocated = 0;
+    self->reserved = 0;
+    self->used = 0;
+    self->deleted = 0;
+    self->seed = HASH_FUNCTION_SEED;
+    if (hash_map_u64_rehash(self, HASH_MAP_INIT_SIZE) == MEMORY_ERROR)
+    {
+        free(self);
+        return NULL;
+    }
+    return self;
+}
+
+void hash_map_u64_dtor(hash_map_u64_t* self)
+{
+    hash_map_u64_release(self);
+    free(self);
+}
+
+void hash_map_u64_clear(hash_map_u64_t* self)
+{
+    hash_map_ctrl_init(self->ctrl, self->allocated);
+    self->used = 0;
+    self->deleted = 0;
+}
+
+hash_map_state_code_t hash_map_u64_reserve(hash_map_u64_t* self, size_t size)
+{
+    if (size < self->used)
+    {
+        return VALUE_ERROR;
+    }
+    if (size != self->allocated && hash_map_u64_rehash(self, size) == MEMORY_ERROR)
+    {
+        // index zustal puvodni, mez pro zmenseni take
+        return MEMORY_ERROR;
+    }
+    self->reserved = size;
+    return OK;
+}
+
+size_t hash_map_u64_size(hash_map_u64_t* self)
+{
+    return self->used;
+}
+
+size_t hash_map_u64_capacity(hash_map_u64_t* self)
+{
+    return self->allocated;
+}
+
+bool hash_map_u64_contains(hash_map_u64_t* self, uint64_t key)
+{
+    bool found;
+    hash_map_u64_probe(self, key, hash_map_u64_hash(self, key), &found);
+    return found;
+}
+
+hash_map_state_code_t hash_map_u64_put(hash_map_u64_t* self, uint64_t key, int value)
+{
+    hash_map_u64_slot_t* slot;
+    hash_map_state_code_t state = hash_map_u64_upsert(self, key, value, &slot);
+    if (state == KEY_ALREADY_EXISTS)
+    {
+        slot->value = value;
+    }
+    return state;
+}
+
+hash_map_state_code_t hash_map_u64_get(hash_map_u64_t* self, uint64_t key, int* dst)
+{
+    bool found;
+    size_t idx = hash_map_u64_probe(self, key, hash_map_u64_hash(self, key), &found);
+    if (!found)
+    {
+        // klic neni asociovan se zadnym zaznamem
+        return KEY_ERROR;
+    }
+    *dst = self->slots[idx].value;
+    return OK;
+}
+
+hash_map_state_code_t hash_map_u64_pop(hash_map_u64_t* self, uint64_t key, int* dst)
+{
+    bool found;
+    size_t idx = hash_map_u64_probe(self, key, hash_map_u64_hash(self, key), &found);
+    if (!found)
+    {
+        return KEY_ERROR;
+    }
+    *dst = self->slots[idx].value;
+    self->used--;
+
+    self->deleted += hash_map_ctrl_erase(self->ctrl, idx);
+
+    // zmenseni indexu pri nizkem zaplneni
+    size_t size = hash_map_shrink_size(self->used, self->allocated, self->reserved);
+    if (size != self->allocated)
+    {
+        hash_map_u64_rehash(self, size);
     }
+    return OK;
+}
+
+hash_map_state_code_t hash_map_u64_remove(hash_map_u64_t* self, uint64_t key)
+{
+    int value;
+    return hash_map_u64_pop(self, key, &value);
+}
 
+hash_map_state_code_t hash_map_u64_increment(hash_map_u64_t* self, uint64_t key, int delta, 
+                                             int* new_value)
+{
+    hash_map_u64_slot_t* slot;
+    hash_map_state_code_t state = hash_map_u64_upsert(self, key, delta, &slot);
+    if (state == MEMORY_ERROR)
+    {
+        return MEMORY_ERROR;
+    }
+    if (state == KEY_ALREADY_EXISTS)
+    {
+        slot->value += delta;
+    }
+    if (new_value != NULL)
+    {
+        *new_value = slot->value;
+    }
     return OK;
 }
 
@@ -25,18 +25,61 @@
 #include <stdlib.h>
 #include <string.h>     
 #include <stddef.h>
+#include <stdint.h>
 #include <stdbool.h>
+#include <pthread.h>
 
 /** Inicializační velikost tabulky. */
 #define HASH_MAP_INIT_SIZE 8                    
-/** Parametr použit v hledání dalšího indexu při kolizi. */
-#define HASH_MAP_PERTURB_SHIFT 5                
+/** Počet míst indexu, jejichž řídicí bajty se porovnávají najednou. */
+#define HASH_MAP_GROUP_WIDTH 16
+/** Řídicí bajt prázdného místa v indexu. */
+#define HASH_MAP_CTRL_EMPTY 0x80
+/** Řídicí bajt místa, ze kterého byl záznam odstraněn. */
+#define HASH_MAP_CTRL_DELETED 0xfe
+/** Řídicí bajt výplně za koncem indexu do celé skupiny. */
+#define HASH_MAP_CTRL_SENTINEL 0xff
+/** Návratová hodnota vyhledávání, pokud záznam neexistuje. */
+#define HASH_MAP_NOT_FOUND ((size_t)-1)
 /** Mez zaplnění kdy se má realokovat velikost tabulky. */
 #define HASH_MAP_REALLOCATION_THRESHOLD 3/5.
-/** Hyperparametr v hašovácí funkci. */
-#define HASH_FUNCTION_PARAM_A 1794967309        
-/** Hyperparametr v hašovácí funkci. */
-#define HASH_FUNCTION_PARAM_B 7                 
+/** Mez zaplnění, pod kterou se při odstranění záznamu index zmenší. */
+#define HASH_MAP_SHRINK_THRESHOLD 1/8.
+/** Počet záznamů původního pole přesunutých jednou operací při postupné 
+ *  realokaci. */
+#define HASH_MAP_MIGRATION_STEP 32
+/** Počet klíčů, jejichž místa v indexu se v dávkových operacích načítají 
+ *  najednou. */
+#define HASH_MAP_BATCH_SIZE 32
+/** Velikost řádku cache, na kterou jsou zarovnány oddíly souběžné tabulky. */
+#define HASH_MAP_CACHE_LINE 64
+/** Průměrný počet klíčů zmrazené tabulky se společným pilotem. */
+#define HASH_MAP_FROZEN_BUCKET_SIZE 4
+/** Verze formátu souboru se zmrazenou tabulkou, mění se s každou změnou 
+ *  rozložení nebo hašovací funkce. */
+#define HASH_MAP_IMAGE_VERSION 2
+/** Nejmenší blok slabu, velikosti bloků jsou jeho násobky. */
+#define HASH_MAP_SLAB_ALIGN 16
+/** Největší blok (klíč) přidělovaný ze slabu. */
+#define HASH_MAP_SLAB_MAX_BLOCK 256
+/** Počet velikostních tříd slabu. */
+#define HASH_MAP_SLAB_CLASSES (HASH_MAP_SLAB_MAX_BLOCK / HASH_MAP_SLAB_ALIGN)
+/** Velikost prvního bloku paměti slabu, další bloky se zdvojnásobují. */
+#define HASH_MAP_SLAB_MIN_CHUNK 1024
+/** Největší blok paměti alokovaný slabem najednou. */
+#define HASH_MAP_SLAB_MAX_CHUNK 65536
+/** Počet tříd histogramu délek hledání, poslední třída zahrnuje i všechna 
+ *  delší hledání. */
+#define HASH_MAP_STATS_PROBES 16
+#ifndef HASH_MAP_STATS
+/** Počítání délek hledání a přestaveb indexu (viz @c hash_map_stats ), lze 
+ *  vypnout při překladu hodnotou 0. */
+#define HASH_MAP_STATS 1
+#endif
+#ifndef HASH_FUNCTION_SEED
+/** Výchozí semínko hašovací funkce, lze přepsat při překladu. */
+#define HASH_FUNCTION_SEED 0x243f6a8885a308d3ull
+#endif
 
 // Informace pro C++ překladač, aby použil "C" linker pro následující funkce.
 extern "C" {
@@ -57,17 +100,39 @@ typedef enum {
     MEMORY_ERROR,           ///< Problém při alokaci paměti.
     VALUE_ERROR,            ///< Neplatná hodnota argumentu.
     KEY_ERROR,              ///< Přístup ke klíči který není vložen v tabulce.
-    KEY_ALREADY_EXISTS      ///< Klíč již v hašovací tabulce existuje.
+    KEY_ALREADY_EXISTS,     ///< Klíč již v hašovací tabulce existuje.
+    IO_ERROR                ///< Chyba zápisu nebo čtení souboru.
 } hash_map_state_code_t;
 
+/**
+ * @brief Způsob prohledávání indexu, volí se při konstrukci tabulky.
+ */
+typedef enum {
+    /** Skupiny řídicích bajtů porovnávané najednou, odstranění zanechá 
+     *  odstraněné místo. */
+    HASH_MAP_PROBING_GROUPS,
+    /** Lineární prohledávání s Robin Hood přesuny a odstraněním posunem 
+     *  následníků zpět, index nikdy neobsahuje odstraněná místa. */
+    HASH_MAP_PROBING_ROBIN_HOOD
+} hash_map_probing_t;
+
 /**
  * @brief Záznam v hašovací tabulce.
  * 
- * Položka v hašovací tabulce. Pro efektivnější procházení (např. při dealokaci 
- * paměti) a prací s pamětí (projeví se při velkých indexech) jsou vložené 
- * položky implementované formou obousměrně vázaného seznamu a index obsahuje 
- * pouze ukazatele do tohoto seznamu. Pořadí položek v seznamu odpovídá pořadí 
- * vložení daného klíče do tabulky. 
+ * Položka v hašovací tabulce. Vložené položky leží za sebou v hustém poli 
+ * záznamů v pořadí vložení klíčů do tabulky a index obsahuje pouze offsety do 
+ * tohoto pole. Procházení tabulky je tak průchodem souvislou pamětí. 
+ * Odstraněná položka zůstává v poli s klíčem @c NULL , dokud pole není 
+ * setřeseno při přestavbě indexu.
+ * 
+ * Klíč je uložen ve slabu tabulky. Klíč je libovolná posloupnost bajtů dané 
+ * délky (může obsahovat i nulové bajty); za klíč se navíc ukládá ukončující 
+ * nula, aby řetězcové klíče šlo číst přímo jako řetězce.
+ * 
+ * Hodnota je @c int , 64bitové číslo nebo ukazatel, podle toho, kterými 
+ * funkcemi se do tabulky vkládá. Tabulka s hodnotami pevné velikosti (viz 
+ * @c hash_map_ctor_with_value_size ) ukládá hodnotu za klíč do stejného 
+ * bloku slabu.
  * 
  * Uživatel by k položkám struktury neměl přistupovat přímo, ale pomocí 
  * definovaného rozhraní níže. Nicméně v rámci testování můžete přímo testovat, 
@@ -75,31 +140,271 @@ typedef enum {
  */
 typedef struct hash_map_item
 {
-    char* key;                  ///< Klíč
+    char* key;                  ///< Klíč, u odstraněné položky @c NULL
+    size_t key_len;             ///< Délka klíče v bajtech (bez ukončující nuly)
     size_t hash;                ///< Hash
-    int value;                  ///< Uložená hodnota
-    struct hash_map_item* next; ///< Následující položka 
-    struct hash_map_item* prev; ///< Předcházející položka
+    union
+    {
+        int value;              ///< Uložená hodnota
+        uint64_t value_u64;     ///< Uložená 64bitová hodnota
+        void* value_ptr;        ///< Uložený ukazatel
+    };
 } hash_map_item_t;
 
+/**
+ * @brief Funkce volaná před vyřazením záznamu z tabulky v režimu cache.
+ * 
+ * Záznam (klíč i hodnota) je během volání ještě platný. Funkce nesmí tabulku 
+ * měnit ani v ní hledat.
+ * 
+ * @param[in] ctx  Kontext zadaný při konstrukci tabulky.
+ * @param[in] item Vyřazovaný záznam.
+ */
+typedef void (*hash_map_evict_t)(void* ctx, const hash_map_item_t* item);
+
+/**
+ * @brief Uživatelské funkce pro alokaci paměti hašovací tabulky.
+ * 
+ * Funkce dostávají kontext @c ctx a při uvolnění také velikost bloku, se 
+ * kterou byl blok alokován, takže je lze napojit na vlastní arénu nebo pool.
+ */
+typedef struct hash_map_allocator
+{
+    /** Alokuje blok o zadané velikosti, v případě chyby vrací @c NULL . */
+    void* (*alloc)(void* ctx, size_t size);
+    /** Uvolní blok alokovaný funkcí @c alloc . */
+    void (*release)(void* ctx, void* ptr, size_t size);
+    void* ctx;                  ///< Kontext předávaný oběma funkcím
+} hash_map_allocator_t;
+
+/**
+ * @brief Slab pro klíče hašovací tabulky.
+ * 
+ * Klíče se přidělují z větších bloků paměti postupným posunem ukazatele. 
+ * Uvolněné klíče se vrací do seznamu volných bloků své velikostní třídy a 
+ * jsou znovu použity při dalším vložení. Bloky paměti se uvolňují najednou až 
+ * při vyprázdnění nebo zrušení tabulky. Klíče větší než 
+ * @c HASH_MAP_SLAB_MAX_BLOCK se alokují přímo alokátorem tabulky.
+ */
+typedef struct hash_map_slab
+{
+    struct hash_map_chunk* chunks;  ///< Seznam alokovaných bloků paměti
+    char* cursor;                   ///< Volné místo v aktuálním bloku
+    size_t remaining;               ///< Velikost volného místa v bloku
+    /** Seznamy uvolněných bloků pro jednotlivé velikostní třídy. */
+    void* free_lists[HASH_MAP_SLAB_CLASSES];
+    size_t large;                   ///< Počet klíčů mimo slab
+    size_t used_bytes;              ///< Velikost přidělených bloků klíčů
+} hash_map_slab_t;
+
+/**
+ * @brief Počítadla hašovací tabulky.
+ * 
+ * Počítadla jsou součástí tabulky i při vypnutém @c HASH_MAP_STATS , 
+ * rozložení struktury tak nezávisí na přepínačích překladu.
+ */
+typedef struct hash_map_counters
+{
+    /** Počty úspěšných hledání podle délky hledání. */
+    size_t probe_hits[HASH_MAP_STATS_PROBES];
+    /** Počty neúspěšných hledání podle délky hledání. */
+    size_t probe_misses[HASH_MAP_STATS_PROBES];
+    size_t resizes;             ///< Počet přestaveb indexu
+    uint64_t rehash_ns;         ///< Celková doba přestaveb indexu v ns
+} hash_map_counters_t;
+
 /**
  * @brief Datový typ hašovací tabulky. 
  * 
+ * Ke každému místu indexu patří řídicí bajt v poli @c ctrl . Obsazené místo 
+ * má v řídicím bajtu uloženo nejnižších sedm bitů haše záznamu, ostatní 
+ * místa jsou označena jako prázdná, odstraněná nebo jako výplň. Vyhledávání 
+ * tak porovnává celé skupiny řídicích bajtů najednou a záznamy v poli záznamů 
+ * dereferencuje jen u míst se shodným otiskem haše. Místa indexu obsahují 
+ * offsety do pole záznamů o šířce 1, 2, 4 nebo 8 bajtů podle kapacity pole.
+ * 
  * Uživatel by k položkám struktury neměl přistupovat přímo, ale pomocí 
  * definovaného rozhraní níže. Nicméně v rámci testování můžete přímo testovat, 
  * zda rozhraní pracuje s tímto datovým typem korektně.
  */
 typedef struct hash_map
 {
-    hash_map_item_t** index;    ///< Index hašovací tabulky
-    hash_map_item_t* first;     ///< První položka v seznamu
-    hash_map_item_t* last;      ///< Poslední položka v seznamu
-    /** Při odstranění je položka v indexu nahrazena tímto ukazatelem. */
-    hash_map_item_t* dummy;     
+    void* index;                ///< Index hašovací tabulky (offsety záznamů)
+    uint8_t index_width;        ///< Šířka offsetu v indexu v bajtech
+    /** Řídicí bajty indexu zarovnané na celé skupiny. */
+    uint8_t* ctrl;
+    /** Husté pole záznamů v pořadí vložení. */
+    hash_map_item_t* entries;
+    /** Počet obsazených záznamů pole včetně odstraněných. */
+    size_t entries_used;
+    size_t entries_allocated;   ///< Kapacita pole záznamů
+    hash_map_item_t* first;     ///< První živá položka v poli záznamů
+    hash_map_item_t* last;      ///< Poslední živá položka v poli záznamů
     size_t allocated;           ///< Alokované místo (velikost indexu)
-    size_t used;                ///< Počet vložených položek (velikost seznamu)
+    /** Velikost z posledního volání @c hash_map_reserve , pod kterou se index 
+     *  při odstraňování záznamů nezmenšuje. */
+    size_t reserved;
+    size_t used;                ///< Počet vložených (živých) položek
+    size_t deleted;             ///< Počet odstraněných míst v indexu
+    /** Původní index během postupné realokace, jinak @c NULL . */
+    void* old_index;
+    uint8_t old_width;          ///< Šířka offsetu v původním indexu
+    uint8_t* old_ctrl;          ///< Řídicí bajty původního indexu
+    size_t old_allocated;       ///< Velikost původního indexu
+    /** Původní pole záznamů během postupné realokace. */
+    hash_map_item_t* old_entries;
+    size_t old_entries_used;    ///< Počet obsazených záznamů původního pole
+    /** Kapacita původního pole záznamů. */
+    size_t old_entries_allocated;
+    size_t migrated;            ///< Počet již zpracovaných záznamů původního pole
+    /** Počet záznamů přesunutých na začátek nového pole. */
+    size_t copied;
+    /** Offset, od kterého se během postupné realokace připojují nové záznamy. */
+    size_t entries_base;
+    bool incremental;           ///< Realokuje se index postupně?
+    hash_map_probing_t probing; ///< Způsob prohledávání indexu
+    /** Velikost hodnoty uložené za klíčem, nebo 0. */
+    size_t value_size;
+    /** Největší vzdálenost záznamu od domovského místa (Robin Hood), 
+     *  neúspěšné hledání nepokračuje dál. */
+    size_t max_probe;
+    uint64_t seed;              ///< Semínko hašovací funkce
+    hash_map_allocator_t allocator; ///< Alokátor paměti tabulky
+    hash_map_slab_t slab;       ///< Slab pro klíče
+    /** Největší počet záznamů v režimu cache (LRU), jinak 0. */
+    size_t cache_capacity;
+    hash_map_evict_t evict;     ///< Funkce volaná před vyřazením záznamu
+    void* evict_ctx;            ///< Kontext funkce @c evict
+    /** Počítají se délky hledání? Tabulky sdílené čtenáři je nepočítají. */
+    bool count_probes;
+    hash_map_counters_t counters; ///< Počítadla statistik
 } hash_map_t;
 
+/**
+ * @brief Místo tabulky s celočíselnými klíči.
+ */
+typedef struct hash_map_u64_slot
+{
+    uint64_t key;               ///< Klíč
+    int value;                  ///< Uložená hodnota
+} hash_map_u64_slot_t;
+
+/**
+ * @brief Hašovací tabulka s celočíselnými klíči.
+ * 
+ * Tabulka používá stejné řídicí bajty a skupinové prohledávání jako 
+ * @c hash_map_t , místa indexu ale obsahují přímo klíč a hodnotu. Vložení 
+ * tak nealokuje klíč a porovnání klíče je porovnání dvou čísel. Haš klíče 
+ * se při přestavbě indexu počítá znovu, jde o jediné násobení.
+ */
+typedef struct hash_map_u64
+{
+    hash_map_u64_slot_t* slots; ///< Místa indexu s klíči a hodnotami
+    uint8_t* ctrl;              ///< Řídicí bajty zarovnané na celé skupiny
+    size_t allocated;           ///< Velikost indexu
+    /** Velikost z posledního volání @c hash_map_u64_reserve . */
+    size_t reserved;
+    size_t used;                ///< Počet vložených záznamů
+    size_t deleted;             ///< Počet odstraněných míst v indexu
+    uint64_t seed;              ///< Semínko hašovací funkce
+} hash_map_u64_t;
+
+/**
+ * @brief Oddíl souběžné hašovací tabulky.
+ * 
+ * Oddíl je zarovnaný na celý řádek cache, aby si zámky sousedních oddílů 
+ * nepřepisovala vlákna pracující s různými oddíly.
+ */
+typedef struct alignas(HASH_MAP_CACHE_LINE) hash_map_shard
+{
+    pthread_rwlock_t lock;      ///< Zámek oddílu (čtenáři sdílí, zápis výhradně)
+    hash_map_t* map;            ///< Tabulka se záznamy oddílu
+} hash_map_shard_t;
+
+/**
+ * @brief Struktura souběžné hašovací tabulky.
+ * 
+ * Klíče jsou rozděleny mezi nezávisle zamykané oddíly podle horních bitů haše,
+ * vlákna pracující s různými oddíly se tedy vzájemně neblokují. Dolní bity 
+ * haše dále používá index oddílu, oddíl tak vidí stále rovnoměrné rozložení.
+ */
+typedef struct hash_map_concurrent
+{
+    hash_map_shard_t* shards;   ///< Pole oddílů
+    size_t shard_count;         ///< Počet oddílů (mocnina dvou)
+    unsigned shard_bits;        ///< Počet horních bitů haše určujících oddíl
+    uint64_t seed;              ///< Semínko hašovací funkce (shodné v oddílech)
+} hash_map_concurrent_t;
+
+/**
+ * @brief Statistiky hašovací tabulky.
+ * 
+ * Délka hledání je počet prošlých skupin řídicích bajtů, u tabulky 
+ * prohledávané metodou Robin Hood počet prošlých míst indexu. Třída @c i 
+ * histogramu odpovídá délce @c i+1 .
+ */
+typedef struct hash_map_stats
+{
+    size_t live;                ///< Počet živých záznamů
+    size_t tombstones;          ///< Počet odstraněných míst v indexu
+    size_t dead_entries;        ///< Počet odstraněných záznamů v poli záznamů
+    size_t capacity;            ///< Velikost indexu
+    double load_factor;         ///< Podíl živých záznamů a velikosti indexu
+    /** Počty úspěšných hledání podle délky hledání. */
+    size_t probe_hits[HASH_MAP_STATS_PROBES];
+    /** Počty neúspěšných hledání podle délky hledání. */
+    size_t probe_misses[HASH_MAP_STATS_PROBES];
+    size_t resizes;             ///< Počet přestaveb indexu
+    uint64_t rehash_ns;         ///< Celková doba přestaveb indexu v ns
+    size_t item_bytes;          ///< Paměť pole záznamů
+    size_t key_bytes;           ///< Paměť bloků klíčů (včetně hodnot)
+    size_t index_bytes;         ///< Paměť indexu a řídicích bajtů
+} hash_map_stats_t;
+
+/**
+ * @brief Záznam zmrazené hašovací tabulky.
+ */
+typedef struct hash_map_frozen_slot
+{
+    union
+    {
+        int value;              ///< Uložená hodnota
+        uint64_t value_u64;     ///< Uložená 64bitová hodnota
+        void* value_ptr;        ///< Uložený ukazatel
+    };
+    uint32_t key_offset;        ///< Začátek klíče v poli klíčů
+    uint32_t key_len;           ///< Délka klíče v bajtech
+} hash_map_frozen_slot_t;
+
+/**
+ * @brief Neměnná hašovací tabulka s minimální perfektní hašovací funkcí.
+ * 
+ * Klíče jsou rozděleny do skupin po průměrně 
+ * @c HASH_MAP_FROZEN_BUCKET_SIZE klíčích. Každá skupina má pilota, se kterým 
+ * haš každého jejího klíče určuje jiný, dosud volný záznam (PTHash). Záznamů 
+ * je přesně tolik, kolik klíčů, klíče jsou uloženy za sebou v jednom poli. 
+ * Hodnoty pevné velikosti leží v samostatném poli ve stejném pořadí jako 
+ * záznamy. Struktura, záznamy, piloti, hodnoty i klíče leží v jednom 
+ * alokovaném bloku, nebo záznamy, piloti, hodnoty a klíče leží v souboru 
+ * namapovaném do paměti (viz @c hash_map_open_mmap ).
+ */
+typedef struct hash_map_frozen
+{
+    size_t count;               ///< Počet záznamů
+    size_t buckets;             ///< Počet skupin klíčů
+    uint64_t seed;              ///< Semínko hašovací funkce
+    hash_map_frozen_slot_t* slots; ///< Záznamy na pozicích daných pilotem
+    uint32_t* pilots;           ///< Pilot každé skupiny klíčů
+    size_t value_size;          ///< Velikost hodnoty pevné velikosti, nebo 0
+    char* values;               ///< Hodnoty pevné velikosti v pořadí záznamů
+    char* keys;                 ///< Klíče uložené za sebou
+    size_t key_bytes;           ///< Velikost pole klíčů v bajtech
+    size_t size;                ///< Velikost celého bloku v bajtech
+    hash_map_allocator_t allocator; ///< Alokátor bloku
+    void* mapping;              ///< Namapovaný soubor, nebo @c NULL
+    size_t mapping_size;        ///< Velikost namapovaného souboru v bajtech
+} hash_map_frozen_t;
+
 /*******************************************************************************
  * Inicializace, deinicializace & alokace paměti
  ******************************************************************************/
@@ -124,6 +429,123 @@ typedef struct hash_map
  */
 hash_map_t* hash_map_ctor();
 
+/**
+ * @brief Konstruktor hašovací tabulky s vlastním alokátorem.
+ * 
+ * Vytvoří tabulku stejně jako @c hash_map_ctor , veškerou paměť (strukturu 
+ * tabulky, index i bloky slabu) však alokuje pomocí zadaných funkcí.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_allocator_t allocator = { my_alloc, my_release, my_pool };
+ * hash_map_t* map = hash_map_ctor_with_allocator(&allocator);
+ * // do something
+ * hash_map_dtor(map);
+ * @endcode
+ * 
+ * @param[in] allocator Alokátor, hodnota @c NULL znamená @c malloc a @c free .
+ * 
+ * @return Ukazatel na inicializovanou hašovací tabulku. V případě chyby alokace
+ *         vrací hodnotu @c NULL.
+ *
+ * @see hash_map_ctor
+ */
+hash_map_t* hash_map_ctor_with_allocator(const hash_map_allocator_t* allocator);
+
+/**
+ * @brief Konstruktor hašovací tabulky se zvoleným způsobem prohledávání.
+ * 
+ * V režimu @c HASH_MAP_PROBING_ROBIN_HOOD se záznam při vkládání posouvá 
+ * lineárně od svého domovského místa a vytlačí záznam, který je svému 
+ * domovskému místu blíže. Rozptyl délek hledání je tak malý i při vysokém 
+ * zaplnění. Odstranění posune následující záznamy o místo zpět, index proto 
+ * neobsahuje odstraněná místa. Hledání chybějícího klíče skončí nejpozději 
+ * po @c max_probe místech.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_t* map = hash_map_ctor_with_probing(HASH_MAP_PROBING_ROBIN_HOOD);
+ * // do something
+ * hash_map_dtor(map);
+ * @endcode
+ * 
+ * @note Index v režimu Robin Hood se vždy realokuje najednou, viz 
+ *       @c hash_map_incremental_resize .
+ * 
+ * @param[in] probing Způsob prohledávání indexu.
+ * 
+ * @return Ukazatel na inicializovanou hašovací tabulku. V případě chyby alokace
+ *         vrací hodnotu @c NULL.
+ *
+ * @see hash_map_ctor
+ */
+hash_map_t* hash_map_ctor_with_probing(hash_map_probing_t probing);
+
+/**
+ * @brief Konstruktor hašovací tabulky s hodnotami pevné velikosti.
+ * 
+ * Každý záznam má kromě hodnoty @c int vlastní blok @p value_size bajtů 
+ * uložený ve slabu hned za klíčem (zarovnaný na 8 bajtů). Hodnota tak leží 
+ * v paměti, kterou hledání čte při porovnání klíče, a není potřeba další 
+ * tabulka ani další hledání.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * typedef struct { double x, y; } point_t;
+ * hash_map_t* map = hash_map_ctor_with_value_size(sizeof(point_t));
+ * point_t p = { 1.0, 2.0 };
+ * hash_map_put_value(map, "home", &p);
+ * point_t* q = (point_t*)hash_map_get_value(map, "home");
+ * hash_map_dtor(map);
+ * @endcode
+ * 
+ * @param[in] value_size Velikost hodnoty v bajtech.
+ * 
+ * @return Ukazatel na inicializovanou hašovací tabulku. V případě chyby alokace
+ *         vrací hodnotu @c NULL.
+ *
+ * @see hash_map_put_value, hash_map_get_value
+ */
+hash_map_t* hash_map_ctor_with_value_size(size_t value_size);
+
+/**
+ * @brief Konstruktor hašovací tabulky v režimu cache (LRU).
+ * 
+ * Pořadí záznamů v poli záznamů je pořadí použití: první záznam je nejdéle 
+ * nepoužitý, poslední naposledy použitý. Úspěšné získání hodnoty 
+ * (@c hash_map_get , @c hash_map_get_u64 , ...) i vložení nebo změna 
+ * existujícího záznamu přesune záznam na konec pole, původní místo v poli 
+ * zůstane jako odstraněný záznam a v indexu se změní jen offset. Pokud 
+ * tabulka obsahuje @p capacity záznamů, vložení nového klíče nejprve vyřadí 
+ * první záznam a zavolá pro něj funkci @p evict . Funkce 
+ * @c hash_map_contains pořadí nemění.
+ * 
+ * @warning Přesun zneplatní ukazatele na záznamy (@c hash_map_item_t ) 
+ *          získané dříve, například z @c hash_map_get_or_insert . Bloky 
+ *          klíčů a hodnot pevné velikosti se nepřesouvají.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_t* cache = hash_map_ctor_lru(1000, NULL, NULL);
+ * int value;
+ * if (hash_map_get(cache, "aloha", &value) == KEY_ERROR)
+ * {
+ *     hash_map_put(cache, "aloha", compute("aloha"));
+ * }
+ * hash_map_dtor(cache);
+ * @endcode
+ * 
+ * @param[in] capacity Největší počet záznamů, alespoň 1.
+ * @param[in] evict    Funkce volaná před vyřazením záznamu, může být @c NULL .
+ * @param[in] ctx      Kontext předávaný funkci @p evict .
+ * 
+ * @return Ukazatel na inicializovanou hašovací tabulku. V případě nulové 
+ *         kapacity nebo chyby alokace vrací hodnotu @c NULL.
+ *
+ * @see hash_map_next
+ */
+hash_map_t* hash_map_ctor_lru(size_t capacity, hash_map_evict_t evict, void* ctx);
+
 /**
  * @brief Destruktor hašovací tabulky.
  *  
@@ -146,6 +568,8 @@ void hash_map_dtor(hash_map_t* self);
 /**
  * @brief Dealokace vytvořeních položek a vymazání indexu.
  * 
+ * Položky ve slabu se uvolní najednou spolu s bloky paměti slabu.
+ * 
  * @param[in] self Ukazatel na strukturu hašovací tabulky.
  */
 void hash_map_clear(hash_map_t* self);
@@ -166,6 +590,9 @@ void hash_map_clear(hash_map_t* self);
  * @warning Velikost indexu nemůže být menší než počet vložených položek, v 
  * takovém případě funkce nic nevykoná a vrátí hodnotu @c VALUE_ERROR . 
  * 
+ * Zadaná velikost je zároveň dolní mezí pro automatické zmenšování indexu 
+ * při odstraňování záznamů.
+ * 
  * @param[in] self Ukazatel na strukturu hašovací tabulky.
  * @param[in] size Velikost indexu.
  * 
@@ -206,6 +633,55 @@ size_t hash_map_size(hash_map_t* self);
  */
 size_t hash_map_capacity(hash_map_t* self);
 
+/**
+ * @brief Zapnutí nebo vypnutí postupné realokace indexu.
+ * 
+ * V režimu postupné realokace nepřestavuje @c hash_map_put index najednou. 
+ * Alokuje pouze nový index a nové pole záznamů, původní index i pole ponechá 
+ * vedle nich; každé další volání @c hash_map_put a @c hash_map_pop přesune 
+ * nejvýše @c HASH_MAP_MIGRATION_STEP záznamů původního pole (odstraněné 
+ * záznamy vynechá). Nové záznamy se připojují za místo vyhrazené přesouvaným 
+ * záznamům. Vyhledávání do dokončení přesunu prohledává oba indexy. Vložení 
+ * záznamu tak nikdy nečeká na přestavbu celého indexu ani na kopii pole.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_t* map = hash_map_ctor();
+ * hash_map_incremental_resize(map, true);
+ * // hash_map_put(map, ...) uz nikdy neprestavuje cely index
+ * @endcode
+ * 
+ * @note Explicitní @c hash_map_reserve a vypnutí režimu probíhající přesun 
+ *       dokončí. Během přesunu se index nezmenšuje. Tabulka v režimu 
+ *       @c HASH_MAP_PROBING_ROBIN_HOOD se realokuje vždy najednou.
+ * 
+ * @param[in] self    Ukazatel na strukturu hašovací tabulky.
+ * @param[in] enabled Má se index realokovat postupně?
+ */
+void hash_map_incremental_resize(hash_map_t* self, bool enabled);
+
+/**
+ * @brief Procházení záznamů tabulky v pořadí vložení.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * for (hash_map_item_t* item = hash_map_next(map, NULL); item != NULL; 
+ *      item = hash_map_next(map, item))
+ * {
+ *     printf("%s: %d\n", item->key, item->value);
+ * }
+ * @endcode
+ * 
+ * @note Vložení nebo odstranění záznamu může pole záznamů přesunout, 
+ *       ukazatel @p item je platný jen do další změny tabulky.
+ * 
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] item Aktuální záznam, nebo @c NULL pro začátek procházení.
+ * 
+ * @return Následující živý záznam, nebo @c NULL na konci tabulky.
+ */
+hash_map_item_t* hash_map_next(hash_map_t* self, hash_map_item_t* item);
+
 /**
  * @brief Obsahuje tabulka záznam s daným klíčem?
  * 
@@ -223,8 +699,10 @@ bool hash_map_contains(hash_map_t* self, const char* key);
 /**
  * @brief Vloží klíč a hodnotu do tabulky.
  * 
- * Pokud je již index tabulky zaplněn ze 2/3, realokuje pro index 2x větší místo
- * v paměti a provede reindexaci. Pokud tabulka již obsahuje k danému klíči 
+ * Pokud je již index tabulky zaplněn ze 3/5 (včetně míst po odstraněných 
+ * záznamech), realokuje pro index 2x větší místo v paměti a provede 
+ * reindexaci. Tvoří-li většinu zaplnění odstraněná místa, index se pouze 
+ * přestaví ve stejné velikosti. Pokud tabulka již obsahuje k danému klíči 
  * záznam, hodnota záznamu se přepíše a funkce vrací hodnotu 
  * @c KEY_ALREADY_EXISTS .
  * 
@@ -282,8 +760,9 @@ hash_map_state_code_t hash_map_get(hash_map_t* self, const char* key,
  * // hash_map_contains(map, "aloha") == false
  * @endcode
  *
- * @warning Odstranění záznamu z tabulky neovlivňuje alokované místo pro 
- *          tabulku.
+ * @warning Klesne-li zaplnění indexu pod @c HASH_MAP_SHRINK_THRESHOLD , 
+ *          odstranění záznamu zmenší index na polovinu, nejvýše však na 
+ *          velikost naposledy zadanou funkci @c hash_map_reserve .
  * 
  * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
  * @param[in]  key   Klíč do tabulky.
@@ -309,8 +788,9 @@ hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key,
  * // hash_map_contains(map, "aloha") == false
  * @endcode
  * 
- * @warning Odstranění záznamu z tabulky neovlivňuje alokované místo pro 
- *          tabulku.
+ * @warning Klesne-li zaplnění indexu pod @c HASH_MAP_SHRINK_THRESHOLD , 
+ *          odstranění záznamu zmenší index na polovinu, nejvýše však na 
+ *          velikost naposledy zadanou funkci @c hash_map_reserve .
  * 
  * @param[in] self Ukazatel na strukturu hašovací tabulky.
  * @param[in] key  Klíč do tabulky.
@@ -322,6 +802,779 @@ hash_map_state_code_t hash_map_pop(hash_map_t* self, const char* key,
  */
 hash_map_state_code_t hash_map_remove(hash_map_t* self, const char* key);
 
+/**
+ * @brief Přičtení hodnoty k záznamu.
+ * 
+ * Pokud tabulka záznam s klíčem neobsahuje, vloží jej s hodnotou @p delta , 
+ * jinak k hodnotě záznamu @p delta přičte. Klíč se hašuje a vyhledává jen 
+ * jednou, na rozdíl od dvojice @c hash_map_get a @c hash_map_put .
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * int count;
+ * hash_map_increment(map, "aloha", 1, &count);
+ * // count == 1
+ * hash_map_increment(map, "aloha", 1, &count);
+ * // count == 2
+ * @endcode
+ * 
+ * @param[in]  self      Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key       Klíč do tabulky.
+ * @param[in]  delta     Přičítaná hodnota.
+ * @param[out] new_value Ukazatel na místo, kde se uloží výsledná hodnota, 
+ *                       může být @c NULL .
+ * 
+ * @return @c MEMORY_ERROR pokud se záznam nepodařilo vložit, jinak @c OK.
+ */
+hash_map_state_code_t hash_map_increment(hash_map_t* self, const char* key, int delta, 
+                                         int* new_value);
+
+/**
+ * @brief Nalezení záznamu, případně jeho vložení, a zpřístupnění hodnoty.
+ * 
+ * Pokud tabulka záznam s klíčem neobsahuje, vloží jej s hodnotou @p value . 
+ * V obou případech uloží do @p slot ukazatel na hodnotu záznamu, kterou lze 
+ * číst i měnit bez dalšího vyhledávání.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * int* slot;
+ * if (hash_map_get_or_insert(map, "aloha", 0, &slot) != MEMORY_ERROR)
+ * {
+ *     *slot += 10;
+ * }
+ * @endcode
+ * 
+ * @warning Ukazatel je platný jen do další změny tabulky.
+ * 
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Klíč do tabulky.
+ * @param[in]  value Hodnota nově vloženého záznamu.
+ * @param[out] slot  Ukazatel na místo, kde se uloží ukazatel na hodnotu.
+ * 
+ * @return @c KEY_ALREADY_EXISTS pokud záznam již existoval, @c MEMORY_ERROR 
+ *         pokud se jej nepodařilo vložit, jinak @c OK.
+ */
+hash_map_state_code_t hash_map_get_or_insert(hash_map_t* self, const char* key, int value, 
+                                             int** slot);
+
+/*******************************************************************************
+ * Metody pro klíče zadané ukazatelem a délkou
+ ******************************************************************************/
+/**
+ * @brief Obsahuje tabulka záznam s daným binárním klíčem?
+ * 
+ * Klíč je posloupnost @p len bajtů a smí obsahovat nulové bajty. Řetězcový 
+ * klíč @c "aloha" odpovídá binárnímu klíči o délce 5, funkce bez přípony 
+ * @c _bytes jsou tedy jen obálky nad těmito funkcemi.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * uint64_t id = 42;
+ * hash_map_put_bytes(map, &id, sizeof(id), 1);
+ * // hash_map_contains_bytes(map, &id, sizeof(id)) == true
+ * @endcode
+ * 
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key  Ukazatel na klíč.
+ * @param[in] len  Délka klíče v bajtech.
+ * 
+ * @return @c true pokud záznam existuje, jinak @c false .
+ * 
+ * @see hash_map_contains
+ */
+bool hash_map_contains_bytes(hash_map_t* self, const void* key, size_t len);
+
+/**
+ * @brief Vložení záznamu s binárním klíčem.
+ * 
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key   Ukazatel na klíč.
+ * @param[in] len   Délka klíče v bajtech.
+ * @param[in] value Hodnota záznamu.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_put .
+ * 
+ * @see hash_map_put
+ */
+hash_map_state_code_t hash_map_put_bytes(hash_map_t* self, const void* key, size_t len, 
+                                         int value);
+
+/**
+ * @brief Získání hodnoty záznamu s binárním klíčem.
+ * 
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Ukazatel na klíč.
+ * @param[in]  len   Délka klíče v bajtech.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ * 
+ * @see hash_map_get
+ */
+hash_map_state_code_t hash_map_get_bytes(hash_map_t* self, const void* key, size_t len, 
+                                         int* value);
+
+/**
+ * @brief Uloží hodnotu záznamu s binárním klíčem a odstraní záznam.
+ * 
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Ukazatel na klíč.
+ * @param[in]  len   Délka klíče v bajtech.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_pop .
+ * 
+ * @see hash_map_pop
+ */
+hash_map_state_code_t hash_map_pop_bytes(hash_map_t* self, const void* key, size_t len, 
+                                         int* value);
+
+/**
+ * @brief Odstranění záznamu s binárním klíčem.
+ * 
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key  Ukazatel na klíč.
+ * @param[in] len  Délka klíče v bajtech.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_remove .
+ * 
+ * @see hash_map_remove
+ */
+hash_map_state_code_t hash_map_remove_bytes(hash_map_t* self, const void* key, size_t len);
+
+/**
+ * @brief Nalezení záznamu s binárním klíčem, případně jeho vložení.
+ * 
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Ukazatel na klíč.
+ * @param[in]  len   Délka klíče v bajtech.
+ * @param[in]  value Hodnota nově vloženého záznamu.
+ * @param[out] slot  Ukazatel na místo, kde se uloží ukazatel na hodnotu.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get_or_insert .
+ * 
+ * @see hash_map_get_or_insert
+ */
+hash_map_state_code_t hash_map_get_or_insert_bytes(hash_map_t* self, const void* key, 
+                                                   size_t len, int value, int** slot);
+
+/*******************************************************************************
+ * Hodnoty jiných typů
+ ******************************************************************************/
+/**
+ * @brief Vložení záznamu s 64bitovou hodnotou.
+ * 
+ * Hodnota se ukládá přímo do položky místo hodnoty @c int . V jedné tabulce 
+ * je proto vhodné používat jen jeden typ hodnot, hodnota vložená funkcí 
+ * @c hash_map_put se čte jako @c int .
+ * 
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key   Klíč.
+ * @param[in] value Hodnota záznamu.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_put .
+ * 
+ * @see hash_map_put
+ */
+hash_map_state_code_t hash_map_put_u64(hash_map_t* self, const char* key, uint64_t value);
+
+/**
+ * @brief Získání 64bitové hodnoty záznamu.
+ * 
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Klíč.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ * 
+ * @see hash_map_get
+ */
+hash_map_state_code_t hash_map_get_u64(hash_map_t* self, const char* key, uint64_t* value);
+
+/**
+ * @brief Vložení záznamu s ukazatelem jako hodnotou.
+ * 
+ * Tabulka ukazatel pouze uchovává, neuvolňuje ani nekopíruje data, na která 
+ * ukazuje.
+ * 
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key   Klíč.
+ * @param[in] value Hodnota záznamu.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_put .
+ * 
+ * @see hash_map_put_u64
+ */
+hash_map_state_code_t hash_map_put_ptr(hash_map_t* self, const char* key, void* value);
+
+/**
+ * @brief Získání ukazatele uloženého jako hodnota záznamu.
+ * 
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  key   Klíč.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ * 
+ * @see hash_map_get_u64
+ */
+hash_map_state_code_t hash_map_get_ptr(hash_map_t* self, const char* key, void** value);
+
+/**
+ * @brief Vložení záznamu s hodnotou pevné velikosti.
+ * 
+ * Zkopíruje @c value_size bajtů z @p value do bloku hodnoty záznamu. 
+ * Existující záznam je přepsán. Záznam vložený funkcí @c hash_map_put má blok 
+ * hodnoty vynulovaný.
+ * 
+ * @param[in] self  Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key   Klíč.
+ * @param[in] value Ukazatel na hodnotu.
+ * 
+ * @return @c VALUE_ERROR pokud tabulka nemá hodnoty pevné velikosti, jinak 
+ *         stejné návratové hodnoty jako @c hash_map_put .
+ * 
+ * @see hash_map_ctor_with_value_size
+ */
+hash_map_state_code_t hash_map_put_value(hash_map_t* self, const char* key, const void* value);
+
+/**
+ * @brief Ukazatel na hodnotu pevné velikosti.
+ * 
+ * Blok hodnoty zůstává na stejném místě, dokud není záznam odstraněn, 
+ * hodnotu lze tedy přes vrácený ukazatel i měnit.
+ * 
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] key  Klíč.
+ * 
+ * @return Ukazatel na blok hodnoty, nebo @c NULL pokud klíč v tabulce není 
+ *         nebo tabulka nemá hodnoty pevné velikosti.
+ * 
+ * @see hash_map_ctor_with_value_size
+ */
+void* hash_map_get_value(hash_map_t* self, const char* key);
+
+/*******************************************************************************
+ * Dávkové operace
+ ******************************************************************************/
+
+/**
+ * @brief Získání hodnot více klíčů najednou.
+ * 
+ * Odpovídá volání @c hash_map_get pro každý klíč. Klíče se zpracovávají po 
+ * dávkách @c HASH_MAP_BATCH_SIZE : nejprve se spočítají haše všech klíčů 
+ * dávky a požádá se o načtení jejich skupin indexu, poté o načtení 
+ * kandidátních položek a teprve potom se vyhledávání dokončí. Výpadky cache 
+ * jednotlivých klíčů se tak překrývají místo toho, aby na sebe čekaly.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * const char* keys[] = { "aloha", "ahoj" };
+ * int values[2];
+ * size_t found = hash_map_get_many(map, keys, 2, values, NULL);
+ * @endcode
+ * 
+ * @param[in]  self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  keys   Pole klíčů.
+ * @param[in]  count  Počet klíčů.
+ * @param[out] values Pole hodnot, u chybějících klíčů se hodnota nemění.
+ * @param[out] states Pole výsledků @c hash_map_get pro jednotlivé klíče, 
+ *                    může být @c NULL .
+ * 
+ * @return Počet nalezených klíčů.
+ * 
+ * @see hash_map_get
+ */
+size_t hash_map_get_many(hash_map_t* self, const char* const* keys, size_t count, 
+                         int* values, hash_map_state_code_t* states);
+
+/**
+ * @brief Vložení více záznamů najednou.
+ * 
+ * Odpovídá volání @c hash_map_put pro každou dvojici klíč-hodnota v pořadí 
+ * polí, tedy i stejnému pořadí záznamů v seznamu. Místa v indexu se načítají 
+ * po dávkách stejně jako v @c hash_map_get_many .
+ * 
+ * @param[in]  self   Ukazatel na strukturu hašovací tabulky.
+ * @param[in]  keys   Pole klíčů.
+ * @param[in]  values Pole hodnot.
+ * @param[in]  count  Počet záznamů.
+ * @param[out] states Pole výsledků @c hash_map_put pro jednotlivé záznamy, 
+ *                    může být @c NULL .
+ * 
+ * @return @c MEMORY_ERROR pokud se některý záznam nepodařilo vložit, 
+ *         jinak @c OK.
+ * 
+ * @see hash_map_put
+ */
+hash_map_state_code_t hash_map_put_many(hash_map_t* self, const char* const* keys, 
+                                        const int* values, size_t count, 
+                                        hash_map_state_code_t* states);
+
+/*******************************************************************************
+ * Souběžná hašovací tabulka
+ ******************************************************************************/
+/**
+ * @brief Konstruktor souběžné hašovací tabulky.
+ * 
+ * Vytvoří tabulku rozdělenou na @p shards oddílů, počet se zaokrouhlí nahoru 
+ * na mocninu dvou. Každý oddíl je samostatná @c hash_map_t s postupnou 
+ * realokací indexu, zápis tak drží zámek oddílu jen omezenou dobu.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_concurrent_t* map = hash_map_concurrent_ctor(16);
+ * // hash_map_concurrent_put(map, ...) z libovolneho vlakna
+ * hash_map_concurrent_dtor(map);
+ * @endcode
+ * 
+ * @param[in] shards Požadovaný počet oddílů, alespoň 1.
+ * 
+ * @return Ukazatel na inicializovanou tabulku. V případě chyby alokace nebo 
+ *         nulového počtu oddílů vrací hodnotu @c NULL.
+ */
+hash_map_concurrent_t* hash_map_concurrent_ctor(size_t shards);
+
+/**
+ * @brief Destruktor souběžné hašovací tabulky.
+ * 
+ * @warning Tabulku nesmí v době volání používat žádné jiné vlákno.
+ * 
+ * @param[in] self Ukazatel na souběžnou hašovací tabulku.
+ */
+void hash_map_concurrent_dtor(hash_map_concurrent_t* self);
+
+/**
+ * @brief Odstranění všech záznamů ze souběžné tabulky.
+ * 
+ * Oddíly se vyprazdňují postupně, souběžně vložené záznamy mohou zůstat.
+ * 
+ * @param[in] self Ukazatel na souběžnou hašovací tabulku.
+ */
+void hash_map_concurrent_clear(hash_map_concurrent_t* self);
+
+/**
+ * @brief Počet záznamů v souběžné tabulce.
+ * 
+ * Při souběžných změnách jde o součet velikostí oddílů v okamžicích jejich 
+ * přečtení, nikoliv o přesný stav v jednom okamžiku.
+ * 
+ * @param[in] self Ukazatel na souběžnou hašovací tabulku.
+ * 
+ * @return Počet záznamů.
+ */
+size_t hash_map_concurrent_size(hash_map_concurrent_t* self);
+
+/**
+ * @brief Obsahuje souběžná tabulka záznam s daným klíčem?
+ * 
+ * @param[in] self Ukazatel na souběžnou hašovací tabulku.
+ * @param[in] key  Klíč do tabulky.
+ * 
+ * @return @c true pokud záznam existuje, jinak @c false .
+ * 
+ * @see hash_map_contains
+ */
+bool hash_map_concurrent_contains(hash_map_concurrent_t* self, const char* key);
+
+/**
+ * @brief Vložení záznamu do souběžné tabulky.
+ * 
+ * @param[in] self  Ukazatel na souběžnou hašovací tabulku.
+ * @param[in] key   Klíč do tabulky.
+ * @param[in] value Hodnota záznamu.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_put .
+ * 
+ * @see hash_map_put
+ */
+hash_map_state_code_t hash_map_concurrent_put(hash_map_concurrent_t* self, 
+                                              const char* key, int value);
+
+/**
+ * @brief Získání hodnoty ze souběžné tabulky.
+ * 
+ * Čtení drží zámek oddílu sdíleně, čtenáři se tedy vzájemně neblokují.
+ * 
+ * @param[in]  self  Ukazatel na souběžnou hašovací tabulku.
+ * @param[in]  key   Klíč do tabulky.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ * 
+ * @see hash_map_get
+ */
+hash_map_state_code_t hash_map_concurrent_get(hash_map_concurrent_t* self, 
+                                              const char* key, int* value);
+
+/**
+ * @brief Uloží hodnotu ze souběžné tabulky a odstraní záznam.
+ * 
+ * @param[in]  self  Ukazatel na souběžnou hašovací tabulku.
+ * @param[in]  key   Klíč do tabulky.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_pop .
+ * 
+ * @see hash_map_pop
+ */
+hash_map_state_code_t hash_map_concurrent_pop(hash_map_concurrent_t* self, 
+                                              const char* key, int* value);
+
+/**
+ * @brief Odstranění záznamu ze souběžné tabulky.
+ * 
+ * @param[in] self Ukazatel na souběžnou hašovací tabulku.
+ * @param[in] key  Klíč do tabulky.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_remove .
+ * 
+ * @see hash_map_remove
+ */
+hash_map_state_code_t hash_map_concurrent_remove(hash_map_concurrent_t* self, 
+                                                 const char* key);
+
+/**
+ * @brief Přičtení hodnoty k záznamu souběžné tabulky.
+ * 
+ * Čtení i zápis hodnoty proběhnou pod jedním zámkem oddílu, souběžná 
+ * přičítání ke stejnému klíči se tedy neztratí.
+ * 
+ * @param[in]  self      Ukazatel na souběžnou hašovací tabulku.
+ * @param[in]  key       Klíč do tabulky.
+ * @param[in]  delta     Přičítaná hodnota.
+ * @param[out] new_value Ukazatel na místo, kde se uloží výsledná hodnota, 
+ *                       může být @c NULL .
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_increment .
+ * 
+ * @see hash_map_increment
+ */
+hash_map_state_code_t hash_map_concurrent_increment(hash_map_concurrent_t* self, 
+                                                    const char* key, int delta, 
+                                                    int* new_value);
+
+/*******************************************************************************
+ * Zmrazená hašovací tabulka
+ ******************************************************************************/
+/**
+ * @brief Vytvoření neměnné tabulky z aktuálních záznamů tabulky.
+ * 
+ * Vyhledání ve zmrazené tabulce spočítá jeden haš, přečte pilota skupiny, 
+ * jeden záznam a porovná jeden klíč. Tabulka nemá volná místa ani index, 
+ * zabírá proto méně paměti než @c hash_map_t . Zdrojová tabulka se nemění 
+ * a lze ji dál používat nebo zrušit, zmrazená tabulka na ní nezávisí.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_frozen_t* config = hash_map_freeze(map);
+ * hash_map_dtor(map);
+ * int value;
+ * hash_map_frozen_get(config, "timeout", &value);
+ * hash_map_frozen_dtor(config);
+ * @endcode
+ * 
+ * Kromě hodnoty položky (@c int , 64bitová hodnota nebo ukazatel) se 
+ * přenáší i hodnoty pevné velikosti (viz @c hash_map_ctor_with_value_size ), 
+ * čte je @c hash_map_frozen_get_value .
+ * 
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * 
+ * @return Ukazatel na zmrazenou tabulku. V případě chyby alokace, součtu 
+ *         délek klíčů nad 4 GiB nebo shody celého haše dvou klíčů vrací 
+ *         hodnotu @c NULL.
+ */
+hash_map_frozen_t* hash_map_freeze(hash_map_t* self);
+
+/**
+ * @brief Destruktor zmrazené tabulky.
+ * 
+ * @param[in] self Ukazatel na zmrazenou tabulku.
+ */
+void hash_map_frozen_dtor(hash_map_frozen_t* self);
+
+/**
+ * @brief Počet záznamů ve zmrazené tabulce.
+ * 
+ * @param[in] self Ukazatel na zmrazenou tabulku.
+ * 
+ * @return Počet záznamů.
+ */
+size_t hash_map_frozen_size(const hash_map_frozen_t* self);
+
+/**
+ * @brief Obsahuje zmrazená tabulka záznam s daným klíčem?
+ * 
+ * @param[in] self Ukazatel na zmrazenou tabulku.
+ * @param[in] key  Klíč.
+ * 
+ * @return @c true pokud záznam existuje, jinak @c false .
+ */
+bool hash_map_frozen_contains(const hash_map_frozen_t* self, const char* key);
+
+/**
+ * @brief Získání hodnoty ze zmrazené tabulky.
+ * 
+ * @param[in]  self  Ukazatel na zmrazenou tabulku.
+ * @param[in]  key   Klíč.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ */
+hash_map_state_code_t hash_map_frozen_get(const hash_map_frozen_t* self, const char* key, 
+                                          int* value);
+
+/**
+ * @brief Získání hodnoty s binárním klíčem ze zmrazené tabulky.
+ * 
+ * @param[in]  self  Ukazatel na zmrazenou tabulku.
+ * @param[in]  key   Ukazatel na klíč.
+ * @param[in]  len   Délka klíče v bajtech.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ */
+hash_map_state_code_t hash_map_frozen_get_bytes(const hash_map_frozen_t* self, 
+                                                const void* key, size_t len, int* value);
+
+/**
+ * @brief Získání 64bitové hodnoty ze zmrazené tabulky.
+ * 
+ * @param[in]  self  Ukazatel na zmrazenou tabulku.
+ * @param[in]  key   Klíč.
+ * @param[out] value Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ * 
+ * @see hash_map_get_u64
+ */
+hash_map_state_code_t hash_map_frozen_get_u64(const hash_map_frozen_t* self, const char* key, 
+                                              uint64_t* value);
+
+/**
+ * @brief Ukazatel na hodnotu pevné velikosti ve zmrazené tabulce.
+ * 
+ * Hodnota leží ve zmrazené tabulce (případně v namapovaném souboru) 
+ * zarovnaná na 8 bajtů a je platná do zrušení tabulky, měnit ji nelze.
+ * 
+ * @param[in] self Ukazatel na zmrazenou tabulku.
+ * @param[in] key  Klíč.
+ * 
+ * @return Ukazatel na blok hodnoty, nebo @c NULL pokud klíč v tabulce není 
+ *         nebo zdrojová tabulka neměla hodnoty pevné velikosti.
+ * 
+ * @see hash_map_get_value
+ */
+const void* hash_map_frozen_get_value(const hash_map_frozen_t* self, const char* key);
+
+/**
+ * @brief Uložení tabulky do souboru.
+ * 
+ * Záznamy tabulky se zmrazí (viz @c hash_map_freeze ) a zapíší se za 
+ * hlavičku s verzí formátu. Soubor neobsahuje ukazatele, pozice záznamů 
+ * i klíčů jsou relativní, lze jej proto přímo namapovat funkcí 
+ * @c hash_map_open_mmap . Soubor se zapíše vedle cílového a teprve poté 
+ * se přejmenuje, procesy s namapovaným původním souborem tak nevidí 
+ * rozepsaný obsah.
+ * 
+ * @note Uložené ukazatele (@c hash_map_put_ptr ) nemají v jiném procesu 
+ *       smysl, soubor je určen pro stejnou architekturu.
+ * 
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ * @param[in] path Cesta k souboru.
+ * 
+ * @return Stav @c OK pokud byl soubor zapsán, @c MEMORY_ERROR pokud se 
+ *         tabulku nepodařilo zmrazit, jinak @c IO_ERROR .
+ */
+hash_map_state_code_t hash_map_save(hash_map_t* self, const char* path);
+
+/**
+ * @brief Otevření tabulky uložené funkcí @c hash_map_save .
+ * 
+ * Soubor se namapuje jen pro čtení a vyhledávání (@c hash_map_frozen_get , 
+ * @c hash_map_frozen_contains , ...) čte přímo z namapované paměti, otevření 
+ * tedy nezávisí na počtu záznamů. Stránky souboru sdílí všechny procesy, 
+ * které jej mají otevřený. Při otevření se kontroluje pouze hlavička 
+ * a velikost souboru. Záznamy se nečtou, vyhledávání ale nikdy nečte klíč 
+ * mimo pole klíčů, poškozený záznam se tak jen nenajde.
+ * 
+ * @param[in] path Cesta k souboru.
+ * 
+ * @return Ukazatel na zmrazenou tabulku, kterou je nutné uvolnit funkcí 
+ *         @c hash_map_frozen_dtor . Pokud soubor nelze otevřít, nebo má 
+ *         jinou verzi či neodpovídající velikost, vrací hodnotu @c NULL .
+ */
+hash_map_frozen_t* hash_map_open_mmap(const char* path);
+
+/*******************************************************************************
+ * Statistiky
+ ******************************************************************************/
+/**
+ * @brief Zjištění statistik hašovací tabulky.
+ * 
+ * Histogramy délek hledání zahrnují každé hledání v indexu, tedy i hledání 
+ * při vkládání a odstraňování. Počítání je přičtení do pole v tabulce, 
+ * při překladu s @c HASH_MAP_STATS rovným 0 se vynechá a histogramy i počet 
+ * přestaveb zůstávají nulové. Oddíly souběžné tabulky délky hledání 
+ * nepočítají, sdílení zápisu mezi čtenáři by omezilo souběžné čtení. Během 
+ * postupné realokace se hledání v obou indexech započte jednou, se součtem 
+ * délek. Doba přestaveb zahrnuje jen přestavby najednou, ne postupný přesun. 
+ * Všechny hodnoty se udržují průběžně, zjištění nezávisí na počtu záznamů.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_stats_t stats;
+ * hash_map_stats(map, &stats);
+ * if (stats.probe_misses[HASH_MAP_STATS_PROBES - 1] > 0)
+ * {
+ *     // nektera hledani prosla alespon 16 skupin
+ * }
+ * @endcode
+ * 
+ * @param[in]  self  Ukazatel na strukturu hašovací tabulky.
+ * @param[out] stats Ukazatel na místo, kam se statistiky uloží.
+ */
+void hash_map_stats(hash_map_t* self, hash_map_stats_t* stats);
+
+/**
+ * @brief Vynulování histogramů délek hledání a počítadel přestaveb.
+ * 
+ * @param[in] self Ukazatel na strukturu hašovací tabulky.
+ */
+void hash_map_stats_reset(hash_map_t* self);
+
+/*******************************************************************************
+ * Tabulka s celočíselnými klíči
+ ******************************************************************************/
+/**
+ * @brief Konstruktor hašovací tabulky s celočíselnými klíči.
+ * 
+ * Funkce tabulky odpovídají funkcím @c hash_map_t se stejným jménem, klíč 
+ * je ale 64bitové číslo. Klíče není potřeba převádět na řetězce.
+ * 
+ * Příklad užití:
+ * @code{.c}
+ * hash_map_u64_t* map = hash_map_u64_ctor();
+ * hash_map_u64_increment(map, user_id, 1, NULL);
+ * hash_map_u64_dtor(map);
+ * @endcode
+ * 
+ * @return Ukazatel na inicializovanou tabulku. V případě chyby alokace 
+ *         vrací hodnotu @c NULL.
+ * 
+ * @see hash_map_ctor
+ */
+hash_map_u64_t* hash_map_u64_ctor();
+
+/**
+ * @brief Destruktor tabulky s celočíselnými klíči.
+ * 
+ * @param[in] self Ukazatel na tabulku.
+ */
+void hash_map_u64_dtor(hash_map_u64_t* self);
+
+/**
+ * @brief Odstranění všech záznamů, velikost indexu zůstane.
+ * 
+ * @param[in] self Ukazatel na tabulku.
+ */
+void hash_map_u64_clear(hash_map_u64_t* self);
+
+/**
+ * @brief Realokace indexu na zadanou velikost.
+ * 
+ * @param[in] self Ukazatel na tabulku.
+ * @param[in] size Velikost indexu.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_reserve .
+ */
+hash_map_state_code_t hash_map_u64_reserve(hash_map_u64_t* self, size_t size);
+
+/**
+ * @brief Počet záznamů v tabulce.
+ * 
+ * @param[in] self Ukazatel na tabulku.
+ * 
+ * @return Počet záznamů.
+ */
+size_t hash_map_u64_size(hash_map_u64_t* self);
+
+/**
+ * @brief Velikost indexu tabulky.
+ * 
+ * @param[in] self Ukazatel na tabulku.
+ * 
+ * @return Počet míst indexu.
+ */
+size_t hash_map_u64_capacity(hash_map_u64_t* self);
+
+/**
+ * @brief Obsahuje tabulka záznam s daným klíčem?
+ * 
+ * @param[in] self Ukazatel na tabulku.
+ * @param[in] key  Klíč.
+ * 
+ * @return @c true pokud záznam existuje, jinak @c false .
+ */
+bool hash_map_u64_contains(hash_map_u64_t* self, uint64_t key);
+
+/**
+ * @brief Vložení záznamu, hodnota existujícího záznamu se přepíše.
+ * 
+ * @param[in] self  Ukazatel na tabulku.
+ * @param[in] key   Klíč.
+ * @param[in] value Hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_put .
+ */
+hash_map_state_code_t hash_map_u64_put(hash_map_u64_t* self, uint64_t key, int value);
+
+/**
+ * @brief Získání hodnoty záznamu.
+ * 
+ * @param[in]  self Ukazatel na tabulku.
+ * @param[in]  key  Klíč.
+ * @param[out] dst  Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_get .
+ */
+hash_map_state_code_t hash_map_u64_get(hash_map_u64_t* self, uint64_t key, int* dst);
+
+/**
+ * @brief Uložení hodnoty a odstranění záznamu.
+ * 
+ * @param[in]  self Ukazatel na tabulku.
+ * @param[in]  key  Klíč.
+ * @param[out] dst  Ukazatel na místo, kde se uloží hodnota.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_pop .
+ */
+hash_map_state_code_t hash_map_u64_pop(hash_map_u64_t* self, uint64_t key, int* dst);
+
+/**
+ * @brief Odstranění záznamu.
+ * 
+ * @param[in] self Ukazatel na tabulku.
+ * @param[in] key  Klíč.
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_remove .
+ */
+hash_map_state_code_t hash_map_u64_remove(hash_map_u64_t* self, uint64_t key);
+
+/**
+ * @brief Přičtení hodnoty k záznamu, chybějící záznam se vloží.
+ * 
+ * @param[in]  self      Ukazatel na tabulku.
+ * @param[in]  key       Klíč.
+ * @param[in]  delta     Přičítaná hodnota.
+ * @param[out] new_value Výsledná hodnota, může být @c NULL .
+ * 
+ * @return Stejné návratové hodnoty jako @c hash_map_increment .
+ */
+hash_map_state_code_t hash_map_u64_increment(hash_map_u64_t* self, uint64_t key, int delta, 
+                                             int* new_value);
+
 }       // extern "C" ending
 
 #endif  // HASH_MAP_H_
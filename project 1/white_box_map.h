@@ -0,0 +1,334 @@
+//======= Copyright (c) 2024, FIT VUT Brno, All rights reserved. ============//
+//
+// Purpose:     White Box - C++ hash map wrapper
+//
+// $NoKeywords: $ivs_project_1 $white_box_map.h
+// $Author:     Marek Čupr <xcuprm01@stud.fit.vutbr.cz>
+// $Date:       $2026-10-18
+//============================================================================//
+/**
+ * @file white_box_map.h
+ *
+ * @brief Třída pro práci s hašovací tabulkou z C++.
+ *
+ * Třída @c HashMap vlastní jednu tabulku @c hash_map_t a uvolní ji ve svém
+ * destruktoru. Klíče předává jako @c std::string_view (ukazatel a délku),
+ * vyhledávání tak nevytváří dočasné řetězce.
+ *
+ * @author Marek Čupr
+ */
+
+#ifndef HASH_MAP_WRAPPER_H_
+#define HASH_MAP_WRAPPER_H_
+
+#include <cstddef>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include "white_box_code.h"
+
+/**
+ * @brief Hašovací tabulka s klíči typu @c std::string_view a hodnotami @c int .
+ *
+ * Tabulku lze pouze přesouvat, kopírování není povoleno. Procházení
+ * (range-for) vrací záznamy v pořadí vložení.
+ *
+ * Příklad užití:
+ * @code{.cpp}
+ * HashMap map;
+ * map["aloha"] += 1;
+ * for (auto [key, value] : map)
+ * {
+ *     std::cout << key << ": " << value << std::endl;
+ * }
+ * @endcode
+ */
+class HashMap{
+public:
+    /**
+     * @brief Záznam zpřístupněný při procházení tabulky.
+     */
+    struct Entry{
+        std::string_view key;   ///< Klíč záznamu
+        int& value;             ///< Hodnota záznamu
+    };
+
+    /**
+     * @brief Dopředný iterátor přes záznamy v pořadí vložení.
+     *
+     * Vložení nebo odstranění záznamu iterátor zneplatní.
+     */
+    class Iterator{
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Entry;
+
+        /**
+         * @brief Konstruktor iterátoru.
+         * @param[in] map  Procházená tabulka.
+         * @param[in] item Aktuální záznam, @c nullptr pro konec.
+         */
+        Iterator(hash_map_t* map, hash_map_item_t* item) : map(map), item(item) { }
+
+        /**
+         * @brief Aktuální záznam.
+         * @return Klíč a odkaz na hodnotu záznamu.
+         */
+        Entry operator*() const{
+            return Entry{std::string_view(item->key, item->key_len), item->value};
+        }
+
+        /**
+         * @brief Posun na následující záznam.
+         * @return Posunutý iterátor.
+         */
+        Iterator& operator++(){
+            item = hash_map_next(map, item);
+            return *this;
+        }
+
+        /**
+         * @brief Posun na následující záznam.
+         * @return Iterátor před posunem.
+         */
+        Iterator operator++(int){
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        /**
+         * @brief Porovnání iterátorů.
+         * @param[in] other Druhý iterátor.
+         * @return True pokud oba iterátory ukazují na stejný záznam.
+         */
+        bool operator==(const Iterator& other) const{
+            return item == other.item;
+        }
+
+        /**
+         * @brief Porovnání iterátorů.
+         * @param[in] other Druhý iterátor.
+         * @return True pokud iterátory ukazují na různé záznamy.
+         */
+        bool operator!=(const Iterator& other) const{
+            return !(*this == other);
+        }
+
+    private:
+        hash_map_t* map;        ///< Procházená tabulka
+        hash_map_item_t* item;  ///< Aktuální záznam
+    };
+
+    /**
+     * @brief Konstruktor prázdné tabulky.
+     * @param[in] probing Způsob prohledávání indexu.
+     * @throw std::bad_alloc Pokud se tabulku nepodařilo alokovat.
+     */
+    explicit HashMap(hash_map_probing_t probing = HASH_MAP_PROBING_GROUPS)
+        : map(hash_map_ctor_with_probing(probing)){
+        if (map == nullptr)
+            throw std::bad_alloc();
+    }
+
+    /**
+     * @brief Destruktor, uvolní tabulku.
+     */
+    ~HashMap(){
+        if (map != nullptr)
+            hash_map_dtor(map);
+    }
+
+    HashMap(const HashMap&) = delete;
+    HashMap& operator=(const HashMap&) = delete;
+
+    /**
+     * @brief Přesun tabulky, původní objekt lze už jen zrušit nebo přiřadit.
+     * @param[in, out] other Přesouvaná tabulka.
+     */
+    HashMap(HashMap&& other) noexcept : map(std::exchange(other.map, nullptr)) { }
+
+    /**
+     * @brief Přesun tabulky, původní tabulka se uvolní s objektem @p other .
+     * @param[in, out] other Přesouvaná tabulka.
+     * @return Odkaz na tento objekt.
+     */
+    HashMap& operator=(HashMap&& other) noexcept{
+        std::swap(map, other.map);
+        return *this;
+    }
+
+    /**
+     * @brief Počet záznamů v tabulce.
+     * @return Počet záznamů.
+     */
+    size_t size() const{
+        return hash_map_size(map);
+    }
+
+    /**
+     * @brief Je tabulka prázdná?
+     * @return True pokud tabulka neobsahuje žádný záznam.
+     */
+    bool empty() const{
+        return size() == 0;
+    }
+
+    /**
+     * @brief Velikost indexu tabulky.
+     * @return Počet míst indexu.
+     */
+    size_t capacity() const{
+        return hash_map_capacity(map);
+    }
+
+    /**
+     * @brief Zajistí místo pro zadaný počet záznamů bez realokace.
+     *
+     * Na rozdíl od @c hash_map_reserve zadává počet záznamů, ne velikost
+     * indexu, a index nikdy nezmenšuje.
+     *
+     * @param[in] count Počet záznamů.
+     * @throw std::bad_alloc Pokud se index nepodařilo alokovat.
+     */
+    void reserve(size_t count){
+        size_t slots = (size_t)(count / (HASH_MAP_REALLOCATION_THRESHOLD)) + 1;
+        if (slots <= capacity())
+            return;
+        if (hash_map_reserve(map, slots) == MEMORY_ERROR)
+            throw std::bad_alloc();
+    }
+
+    /**
+     * @brief Odstraní všechny záznamy, velikost indexu zůstane.
+     */
+    void clear(){
+        hash_map_clear(map);
+    }
+
+    /**
+     * @brief Obsahuje tabulka záznam s daným klíčem?
+     *
+     * Na rozdíl od @c get nemění pořadí záznamů ani v režimu cache.
+     *
+     * @param[in] key Klíč.
+     * @return True pokud záznam existuje.
+     */
+    bool contains(std::string_view key) const{
+        return hash_map_contains_bytes(map, data(key), key.size());
+    }
+
+    /**
+     * @brief Hodnota záznamu s daným klíčem.
+     *
+     * V režimu cache (viz @c hash_map_ctor_lru ) čtení přesune záznam
+     * na konec pořadí vyřazování, metoda proto není konstantní.
+     *
+     * @param[in] key Klíč.
+     * @return Hodnota záznamu, nebo @c std::nullopt pokud klíč v tabulce není.
+     */
+    std::optional<int> get(std::string_view key){
+        int value;
+        if (hash_map_get_bytes(map, data(key), key.size(), &value) != OK)
+            return std::nullopt;
+        return value;
+    }
+
+    /**
+     * @brief Vloží záznam, pokud klíč v tabulce ještě není.
+     *
+     * Existenci klíče i místo pro nový záznam zjistí jediné hledání.
+     *
+     * @param[in] key   Klíč.
+     * @param[in] value Hodnota nově vloženého záznamu.
+     * @return Ukazatel na hodnotu záznamu (platný do další změny tabulky)
+     *         a true pokud byl záznam vložen.
+     * @throw std::bad_alloc Pokud se záznam nepodařilo vložit.
+     */
+    std::pair<int*, bool> try_emplace(std::string_view key, int value = 0){
+        int* slot;
+        hash_map_state_code_t state = hash_map_get_or_insert_bytes(map, data(key), key.size(), value, &slot);
+        if (state == MEMORY_ERROR)
+            throw std::bad_alloc();
+        return {slot, state == OK};
+    }
+
+    /**
+     * @brief Vloží záznam, nebo přepíše hodnotu existujícího záznamu.
+     * @param[in] key   Klíč.
+     * @param[in] value Hodnota záznamu.
+     * @return True pokud byl záznam vložen, false pokud byl přepsán.
+     * @throw std::bad_alloc Pokud se záznam nepodařilo vložit.
+     */
+    bool insert_or_assign(std::string_view key, int value){
+        hash_map_state_code_t state = hash_map_put_bytes(map, data(key), key.size(), value);
+        if (state == MEMORY_ERROR)
+            throw std::bad_alloc();
+        return state == OK;
+    }
+
+    /**
+     * @brief Hodnota záznamu, chybějící záznam se vloží s hodnotou 0.
+     * @param[in] key Klíč.
+     * @return Odkaz na hodnotu (platný do další změny tabulky).
+     * @throw std::bad_alloc Pokud se záznam nepodařilo vložit.
+     */
+    int& operator[](std::string_view key){
+        return *try_emplace(key).first;
+    }
+
+    /**
+     * @brief Odstraní záznam s daným klíčem.
+     * @param[in] key Klíč.
+     * @return True pokud byl záznam odstraněn.
+     */
+    bool erase(std::string_view key){
+        return hash_map_remove_bytes(map, data(key), key.size()) == OK;
+    }
+
+    /**
+     * @brief Iterátor na první záznam v pořadí vložení.
+     * @return Iterátor.
+     */
+    Iterator begin() const{
+        return Iterator(map, hash_map_next(map, nullptr));
+    }
+
+    /**
+     * @brief Iterátor za poslední záznam.
+     * @return Iterátor.
+     */
+    Iterator end() const{
+        return Iterator(map, nullptr);
+    }
+
+    /**
+     * @brief Vlastněná tabulka pro volání C rozhraní.
+     * @return Ukazatel na tabulku.
+     */
+    hash_map_t* native() const{
+        return map;
+    }
+
+private:
+    /**
+     * @brief Ukazatel na data klíče, prázdný klíč nemusí mít žádná data.
+     * @param[in] key Klíč.
+     * @return Platný ukazatel na data klíče.
+     */
+    static const char* data(std::string_view key){
+        return key.data() != nullptr ? key.data() : "";
+    }
+
+    hash_map_t* map;    ///< Vlastněná tabulka
+};
+
+#endif  // HASH_MAP_WRAPPER_H_
+
+/*** Konec souboru white_box_map.h ***/
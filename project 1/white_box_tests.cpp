@@ -14,8 +14,13 @@
  */
 
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
 #include "gtest/gtest.h"
 #include "white_box_code.h"
+#include "white_box_map.h"
 
 using namespace testing;
 
@@ -76,6 +81,236 @@ protected:
     }
 };
 
+// Create hashtable filled with anagrams
+class AnagramHash : public Test
+{
+protected:
+    hash_map_t *anagram_hash;
+
+    // Allocate the memory and insert all permutations of "abcdefg"
+    void SetUp() override {
+        anagram_hash = hash_map_ctor();
+        hash_map_reserve(anagram_hash, 16384);
+
+        std::string key = "abcdefg";
+        int i = 0;
+        do {
+            hash_map_put(anagram_hash, key.c_str(), i++);
+        } while (std::next_permutation(key.begin(), key.end()));
+    }
+
+    // Free the memory
+    void TearDown() override {
+        hash_map_dtor(anagram_hash);
+    }
+
+    // Decode the item referenced by the index slot
+    hash_map_item_t *slot_item(size_t idx) {
+        if (anagram_hash->ctrl[idx] & HASH_MAP_CTRL_EMPTY)
+            return nullptr;
+        const uint8_t *slot = (const uint8_t *)anagram_hash->index + idx * anagram_hash->index_width;
+        uint64_t offset = 0;
+        memcpy(&offset, slot, anagram_hash->index_width);
+        return anagram_hash->entries + offset;
+    }
+
+    // Count index groups visited by the lookup of the item
+    size_t probe_length(hash_map_item_t *item) {
+        size_t groups = (anagram_hash->allocated + HASH_MAP_GROUP_WIDTH - 1) / HASH_MAP_GROUP_WIDTH;
+        size_t home = (item->hash >> 7) % groups;
+        size_t idx = 0;
+        while (slot_item(idx) != item)
+            idx++;
+        return (idx / HASH_MAP_GROUP_WIDTH + groups - home) % groups + 1;
+    }
+};
+
+// Create Robin Hood hashtable close to the reallocation threshold
+class RobinHoodHash : public Test
+{
+protected:
+    hash_map_t *robin_hood_hash;
+    const int key_count = 1200;
+
+    // Allocate the memory
+    void SetUp() override {
+        robin_hood_hash = hash_map_ctor_with_probing(HASH_MAP_PROBING_ROBIN_HOOD);
+        hash_map_reserve(robin_hood_hash, 2048);
+        for (int i = 0; i < key_count; i++)
+            hash_map_put(robin_hood_hash, ("key" + std::to_string(i)).c_str(), i);
+    }
+
+    // Free the memory
+    void TearDown() override {
+        hash_map_dtor(robin_hood_hash);
+    }
+
+    // Distance of the item in the slot from its home slot
+    size_t distance(size_t idx) {
+        const uint8_t *slot = (const uint8_t *)robin_hood_hash->index + idx * robin_hood_hash->index_width;
+        uint64_t offset = 0;
+        memcpy(&offset, slot, robin_hood_hash->index_width);
+        size_t allocated = robin_hood_hash->allocated;
+        size_t home = (robin_hood_hash->entries[offset].hash >> 7) % allocated;
+        return (idx + allocated - home) % allocated;
+    }
+
+    // Check that no item is farther from home than its predecessor plus one
+    void check_displacement() {
+        size_t allocated = robin_hood_hash->allocated;
+        for (size_t idx = 0; idx < allocated; idx++) {
+            ASSERT_NE(robin_hood_hash->ctrl[idx], HASH_MAP_CTRL_DELETED);
+            if (robin_hood_hash->ctrl[idx] == HASH_MAP_CTRL_EMPTY)
+                continue;
+            size_t dist = distance(idx);
+            EXPECT_LE(dist, robin_hood_hash->max_probe);
+            size_t next = (idx + 1) % allocated;
+            if (robin_hood_hash->ctrl[next] != HASH_MAP_CTRL_EMPTY) {
+                EXPECT_LE(distance(next), dist + 1);
+            }
+        }
+    }
+};
+
+// Create hashtable with counting allocator
+class AllocatorHash : public Test
+{
+protected:
+    hash_map_t *allocator_hash;
+    size_t allocations = 0;
+    size_t releases = 0;
+    size_t live_bytes = 0;
+    bool out_of_memory = false;
+
+    static void *count_alloc(void *ctx, size_t size) {
+        AllocatorHash *self = (AllocatorHash *)ctx;
+        if (self->out_of_memory)
+            return nullptr;
+        self->allocations++;
+        self->live_bytes += size;
+        return malloc(size);
+    }
+
+    static void count_release(void *ctx, void *ptr, size_t size) {
+        AllocatorHash *self = (AllocatorHash *)ctx;
+        self->releases++;
+        self->live_bytes -= size;
+        free(ptr);
+    }
+
+    // Allocate the memory
+    void SetUp() override {
+        hash_map_allocator_t allocator = { count_alloc, count_release, this };
+        allocator_hash = hash_map_ctor_with_allocator(&allocator);
+    }
+
+    // Free the memory
+    void TearDown() override {
+        if (allocator_hash != nullptr)
+            hash_map_dtor(allocator_hash);
+        EXPECT_EQ(live_bytes, 0);
+        EXPECT_EQ(allocations, releases);
+    }
+};
+
+// Create sharded hashtable for concurrent access
+class ConcurrentHash : public Test
+{
+protected:
+    hash_map_concurrent_t *concurrent_hash;
+    static const size_t thread_count = 4;
+    static const size_t keys_per_thread = 5000;
+
+    // Allocate the memory
+    void SetUp() override {
+        concurrent_hash = hash_map_concurrent_ctor(8);
+    }
+
+    // Free the memory
+    void TearDown() override {
+        hash_map_concurrent_dtor(concurrent_hash);
+    }
+
+    // Key owned by the given thread
+    static std::string key(size_t thread, size_t i) {
+        return "t" + std::to_string(thread) + "k" + std::to_string(i);
+    }
+};
+
+// Create a bounded LRU cache
+class CacheHash : public Test
+{
+protected:
+    hash_map_t *cache_hash;
+    std::vector<std::pair<std::string, int>> evicted;
+
+    // Record every evicted item
+    static void on_evict(void *ctx, const hash_map_item_t *item) {
+        CacheHash *self = (CacheHash *)ctx;
+        self->evicted.emplace_back(std::string(item->key, item->key_len), item->value);
+    }
+
+    // Allocate the memory and fill the cache with "a", "b", "c", "d"
+    void SetUp() override {
+        cache_hash = hash_map_ctor_lru(4, on_evict, this);
+        for (int i = 0; i < 4; i++)
+            hash_map_put(cache_hash, std::string(1, 'a' + i).c_str(), i);
+    }
+
+    // Free the memory
+    void TearDown() override {
+        hash_map_dtor(cache_hash);
+    }
+
+    // Keys from the least to the most recently used
+    std::string order() {
+        std::string keys;
+        for (hash_map_item_t *item = hash_map_next(cache_hash, nullptr); item != nullptr;
+             item = hash_map_next(cache_hash, item))
+            keys += item->key;
+        return keys;
+    }
+};
+
+// Create a hashtable with integer keys
+class IntegerHash : public Test
+{
+protected:
+    hash_map_u64_t *integer_hash;
+    static const int key_count = 1000;
+
+    // Keys differing only in the upper bits
+    static uint64_t key(int i) {
+        return (uint64_t)i << 40;
+    }
+
+    // Allocate the memory and insert the keys
+    void SetUp() override {
+        integer_hash = hash_map_u64_ctor();
+        for (int i = 0; i < key_count; i++)
+            hash_map_u64_put(integer_hash, key(i), i);
+    }
+
+    // Free the memory
+    void TearDown() override {
+        hash_map_u64_dtor(integer_hash);
+    }
+};
+
+// Create C++ hashtable
+class WrapperHash : public Test
+{
+protected:
+    HashMap map;
+    std::vector<std::string> keys = {"dobry", "den", "jak", "se", "dnes", "mate"};
+
+    // Fill the hashtable
+    void SetUp() override {
+        for (int i = 0; i < keys.size(); i++)
+            map.insert_or_assign(keys[i], i);
+    }
+};
+
 /* ************************** */
 /* ****  EMPTY HASHTABLE **** */
 /* ************************** */
@@ -190,6 +425,472 @@ TEST_F(EmptyHash, hash_map_pop){
     EXPECT_EQ(hash_code, KEY_ERROR);
 }
 
+TEST_F(EmptyHash, hash_map_pop_churn){
+    int value;
+
+    // Keep 50 live keys while inserting and removing 20000 distinct keys
+    for (size_t i = 0; i < 20000; i++) {
+        ASSERT_EQ(hash_map_put(empty_hash, ("key" + std::to_string(i)).c_str(), i), OK);
+        if (i >= 50) {
+            ASSERT_EQ(hash_map_pop(empty_hash, ("key" + std::to_string(i - 50)).c_str(), &value), OK);
+        }
+
+        // Tombstones count against the load limit
+        ASSERT_LE(empty_hash->used + empty_hash->deleted, hash_map_capacity(empty_hash) * 3 / 5 + 1);
+    }
+
+    // Neither the index nor the probe chains grew with the churn
+    EXPECT_EQ(hash_map_size(empty_hash), 50u);
+    EXPECT_LE(hash_map_capacity(empty_hash), 256u);
+    EXPECT_TRUE(hash_map_contains(empty_hash, "key19999"));
+    EXPECT_FALSE(hash_map_contains(empty_hash, "key19949"));
+}
+
+TEST_F(EmptyHash, hash_map_pop_shrink){
+    int value;
+
+    // Fill the hashtable
+    for (size_t i = 0; i < 1000; i++)
+        hash_map_put(empty_hash, ("key" + std::to_string(i)).c_str(), i);
+    size_t hash_capacity = hash_map_capacity(empty_hash);
+    ASSERT_GE(hash_capacity, 1000u);
+
+    // Remove almost everything
+    for (size_t i = 5; i < 1000; i++)
+        ASSERT_EQ(hash_map_pop(empty_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+    EXPECT_EQ(hash_map_size(empty_hash), 5u);
+    EXPECT_LE(hash_map_capacity(empty_hash), 64u);
+    EXPECT_GE(hash_map_capacity(empty_hash), 8u);
+    for (size_t i = 0; i < 5; i++) {
+        EXPECT_EQ(hash_map_get(empty_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+        EXPECT_EQ((size_t)value, i);
+    }
+
+    // Reserved size is kept
+    ASSERT_EQ(hash_map_reserve(empty_hash, 512), OK);
+    ASSERT_EQ(hash_map_pop(empty_hash, "key0", &value), OK);
+    EXPECT_EQ(hash_map_capacity(empty_hash), 512u);
+}
+
+TEST_F(EmptyHash, hash_map_incremental_resize){
+    int value;
+    hash_map_incremental_resize(empty_hash, true);
+
+    // Fill the hashtable up to the reallocation threshold
+    ASSERT_EQ(hash_map_reserve(empty_hash, 1024), OK);
+    for (int i = 0; i < 615; i++)
+        ASSERT_EQ(hash_map_put(empty_hash, ("key" + std::to_string(i)).c_str(), i), OK);
+    EXPECT_EQ(empty_hash->old_index, nullptr);
+
+    // Growth only allocates the new index, the old one is kept
+    ASSERT_EQ(hash_map_put(empty_hash, "key615", 615), OK);
+    EXPECT_EQ(hash_map_capacity(empty_hash), 2048);
+    ASSERT_NE(empty_hash->old_index, nullptr);
+    EXPECT_EQ(empty_hash->old_allocated, 1024);
+    EXPECT_EQ(empty_hash->migrated, HASH_MAP_MIGRATION_STEP);
+
+    // Lookups see the records in both indexes
+    for (int i = 0; i <= 615; i++) {
+        EXPECT_EQ(hash_map_get(empty_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(hash_map_put(empty_hash, "key0", 42), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_put(empty_hash, "key1000", 1000), OK);
+    ASSERT_EQ(hash_map_pop(empty_hash, "key1000", &value), OK);
+    ASSERT_EQ(hash_map_pop(empty_hash, "key614", &value), OK);
+    EXPECT_EQ(value, 614);
+    EXPECT_FALSE(hash_map_contains(empty_hash, "key614"));
+
+    // Every operation moves a bounded part of the old entry array
+    size_t operations = 0;
+    while (empty_hash->old_index != nullptr) {
+        ASSERT_EQ(hash_map_put(empty_hash, ("new" + std::to_string(operations)).c_str(), 0), OK);
+        operations++;
+    }
+    EXPECT_LE(operations, 1024 / HASH_MAP_MIGRATION_STEP);
+    EXPECT_EQ(empty_hash->migrated, 0);
+    EXPECT_EQ(hash_map_size(empty_hash), 615 + operations);
+    EXPECT_EQ(hash_map_get(empty_hash, "key0", &value), OK);
+    EXPECT_EQ(value, 42);
+    EXPECT_FALSE(hash_map_contains(empty_hash, "key614"));
+}
+
+TEST_F(EmptyHash, hash_map_incremental_resize_bounded){
+    int value;
+    hash_map_incremental_resize(empty_hash, true);
+
+    // A single put moves at most one step of the old entry array
+    size_t resizes = 0;
+    auto put = [&](int i) {
+        hash_map_item_t *entries = empty_hash->entries;
+        bool moving = empty_hash->old_index != nullptr;
+        size_t migrated = empty_hash->migrated;
+        size_t used = empty_hash->entries_used;
+        ASSERT_EQ(hash_map_put(empty_hash, ("key" + std::to_string(i)).c_str(), i), OK);
+        if (empty_hash->entries != entries) {
+            // The previous move was finished and the new one is not done at once
+            EXPECT_FALSE(moving);
+            EXPECT_TRUE(empty_hash->old_index != nullptr || used <= HASH_MAP_MIGRATION_STEP);
+            EXPECT_LE(empty_hash->migrated, HASH_MAP_MIGRATION_STEP);
+            EXPECT_LE(empty_hash->copied, HASH_MAP_MIGRATION_STEP);
+            resizes++;
+        } else if (moving && empty_hash->old_index != nullptr) {
+            EXPECT_LE(empty_hash->migrated - migrated, HASH_MAP_MIGRATION_STEP);
+        }
+    };
+
+    // Growth
+    for (int i = 0; i < 5000; i++)
+        put(i);
+    EXPECT_GT(resizes, 0);
+
+    // Churn leaves most of the entries removed, the reserved index does not shrink
+    for (int i = 0; i < 4990; i++)
+        ASSERT_EQ(hash_map_pop(empty_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+    ASSERT_EQ(hash_map_reserve(empty_hash, 1024), OK);
+    resizes = 0;
+    for (int i = 5000; i < 25000; i++) {
+        put(i);
+        ASSERT_EQ(hash_map_pop(empty_hash, ("key" + std::to_string(i - 10)).c_str(), &value), OK);
+    }
+    EXPECT_GT(resizes, 0);
+    EXPECT_EQ(hash_map_capacity(empty_hash), 1024);
+    EXPECT_EQ(hash_map_size(empty_hash), 10);
+    for (int i = 24990; i < 25000; i++) {
+        EXPECT_EQ(hash_map_get(empty_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+        EXPECT_EQ(value, i);
+    }
+}
+
+TEST_F(EmptyHash, entries){
+    int value;
+
+    // Offset width follows the capacity of the entry array
+    EXPECT_EQ(empty_hash->index_width, 1);
+    ASSERT_EQ(hash_map_reserve(empty_hash, 1024), OK);
+    EXPECT_EQ(empty_hash->index_width, 2);
+    EXPECT_EQ(empty_hash->entries_allocated, 615);
+    ASSERT_EQ(hash_map_reserve(empty_hash, 200000), OK);
+    EXPECT_EQ(empty_hash->index_width, 4);
+    ASSERT_EQ(hash_map_reserve(empty_hash, 64), OK);
+
+    // Churn on few keys reuses the entry array instead of growing the index
+    for (int i = 0; i < 10000; i++) {
+        ASSERT_EQ(hash_map_put(empty_hash, ("key" + std::to_string(i % 8)).c_str(), i), i < 8 ? OK : KEY_ALREADY_EXISTS);
+        ASSERT_EQ(hash_map_pop(empty_hash, ("key" + std::to_string(i % 8)).c_str(), &value), OK);
+        ASSERT_EQ(hash_map_put(empty_hash, ("key" + std::to_string(i % 8)).c_str(), i), OK);
+    }
+    EXPECT_EQ(hash_map_size(empty_hash), 8);
+    EXPECT_EQ(hash_map_capacity(empty_hash), 64);
+    EXPECT_LE(empty_hash->entries_used, empty_hash->entries_allocated);
+
+    // Compaction keeps the insertion order
+    int previous = -1;
+    for (hash_map_item_t *item = hash_map_next(empty_hash, nullptr); item != nullptr;
+         item = hash_map_next(empty_hash, item)) {
+        EXPECT_GT(item->value, previous);
+        previous = item->value;
+    }
+    EXPECT_EQ(previous, 9999);
+}
+
+TEST_F(EmptyHash, hash_map_increment){
+    int value;
+
+    // Missing key starts from delta
+    EXPECT_EQ(hash_map_increment(empty_hash, "counter", 5, &value), OK);
+    EXPECT_EQ(value, 5);
+    EXPECT_EQ(hash_map_increment(empty_hash, "counter", -2, &value), OK);
+    EXPECT_EQ(value, 3);
+    EXPECT_EQ(hash_map_increment(empty_hash, "counter", 1, nullptr), OK);
+    EXPECT_EQ(hash_map_get(empty_hash, "counter", &value), OK);
+    EXPECT_EQ(value, 4);
+    EXPECT_EQ(hash_map_size(empty_hash), 1);
+
+    // Counting through index growth
+    for (int round = 0; round < 3; round++)
+        for (int i = 0; i < 100; i++)
+            ASSERT_EQ(hash_map_increment(empty_hash, ("word" + std::to_string(i)).c_str(), i, nullptr), OK);
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(hash_map_get(empty_hash, ("word" + std::to_string(i)).c_str(), &value), OK);
+        EXPECT_EQ(value, 3 * i);
+    }
+}
+
+TEST_F(EmptyHash, hash_map_get_or_insert){
+    int *slot;
+    int value;
+
+    // Missing key is inserted with the given value
+    EXPECT_EQ(hash_map_get_or_insert(empty_hash, "random", 7, &slot), OK);
+    EXPECT_EQ(*slot, 7);
+    EXPECT_EQ(slot, &empty_hash->last->value);
+
+    // Existing key keeps its value and the slot can be updated in place
+    EXPECT_EQ(hash_map_get_or_insert(empty_hash, "random", 100, &slot), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(*slot, 7);
+    *slot = 69;
+    EXPECT_EQ(hash_map_get(empty_hash, "random", &value), OK);
+    EXPECT_EQ(value, 69);
+    EXPECT_EQ(hash_map_size(empty_hash), 1);
+}
+
+TEST_F(EmptyHash, hash_map_put_u64){
+    uint64_t value;
+
+    // Full 64-bit values are kept in the item
+    EXPECT_EQ(hash_map_put_u64(empty_hash, "id", 0x123456789abcdef0ull), OK);
+    EXPECT_EQ(hash_map_get_u64(empty_hash, "id", &value), OK);
+    EXPECT_EQ(value, 0x123456789abcdef0ull);
+    EXPECT_EQ(hash_map_put_u64(empty_hash, "id", UINT64_MAX), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_get_u64(empty_hash, "id", &value), OK);
+    EXPECT_EQ(value, UINT64_MAX);
+    EXPECT_EQ(hash_map_get_u64(empty_hash, "missing", &value), KEY_ERROR);
+
+    // Int value of a new item leaves no garbage in the upper bits
+    EXPECT_EQ(hash_map_put(empty_hash, "small", 7), OK);
+    EXPECT_EQ(hash_map_get_u64(empty_hash, "small", &value), OK);
+    EXPECT_EQ(value, 7);
+}
+
+TEST_F(EmptyHash, hash_map_put_ptr){
+    int data[3] = {1, 2, 3};
+    void *value;
+
+    // Pointers are stored as they are
+    for (int i = 0; i < 3; i++)
+        EXPECT_EQ(hash_map_put_ptr(empty_hash, ("ptr" + std::to_string(i)).c_str(), &data[i]), OK);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_EQ(hash_map_get_ptr(empty_hash, ("ptr" + std::to_string(i)).c_str(), &value), OK);
+        EXPECT_EQ(value, &data[i]);
+    }
+    EXPECT_EQ(hash_map_put_ptr(empty_hash, "null", nullptr), OK);
+    EXPECT_EQ(hash_map_get_ptr(empty_hash, "null", &value), OK);
+    EXPECT_EQ(value, nullptr);
+    EXPECT_EQ(hash_map_get_ptr(empty_hash, "missing", &value), KEY_ERROR);
+}
+
+TEST_F(EmptyHash, hash_map_ctor_with_value_size){
+    struct point { double x, y, z; };
+
+    // Plain map has no fixed-size values
+    point p = {1.0, 2.0, 3.0};
+    EXPECT_EQ(hash_map_put_value(empty_hash, "home", &p), VALUE_ERROR);
+    EXPECT_EQ(hash_map_get_value(empty_hash, "home"), nullptr);
+
+    hash_map_t *points = hash_map_ctor_with_value_size(sizeof(point));
+    ASSERT_NE(points, nullptr);
+    std::string long_key(300, 'x');
+    for (int i = 0; i < 1000; i++) {
+        point q = {(double)i, 2.0 * i, 3.0 * i};
+        ASSERT_EQ(hash_map_put_value(points, ("point" + std::to_string(i)).c_str(), &q), OK);
+    }
+    ASSERT_EQ(hash_map_put_value(points, long_key.c_str(), &p), OK);
+
+    // Values sit behind the keys, aligned and stable
+    for (int i = 0; i < 1000; i++) {
+        point *q = (point *)hash_map_get_value(points, ("point" + std::to_string(i)).c_str());
+        ASSERT_NE(q, nullptr);
+        EXPECT_EQ((uintptr_t)q % 8, 0);
+        EXPECT_EQ(q->y, 2.0 * i);
+    }
+    point *q = (point *)hash_map_get_value(points, long_key.c_str());
+    ASSERT_NE(q, nullptr);
+    EXPECT_EQ(q->z, 3.0);
+    q->z = 4.0;
+    EXPECT_EQ(((point *)hash_map_get_value(points, long_key.c_str()))->z, 4.0);
+    EXPECT_EQ(hash_map_get_value(points, "missing"), nullptr);
+
+    // Items inserted with an int value get a zeroed block
+    EXPECT_EQ(hash_map_put(points, "origin", 1), OK);
+    q = (point *)hash_map_get_value(points, "origin");
+    ASSERT_NE(q, nullptr);
+    EXPECT_EQ(q->x, 0.0);
+
+    EXPECT_EQ(hash_map_remove(points, "point0"), OK);
+    EXPECT_EQ(hash_map_get_value(points, "point0"), nullptr);
+    hash_map_dtor(points);
+}
+
+TEST_F(EmptyHash, hash_map_freeze){
+    int value;
+
+    // Frozen empty table answers every lookup with an error
+    hash_map_frozen_t *frozen = hash_map_freeze(empty_hash);
+    ASSERT_NE(frozen, nullptr);
+    EXPECT_EQ(hash_map_frozen_size(frozen), 0);
+    EXPECT_FALSE(hash_map_frozen_contains(frozen, ""));
+    EXPECT_EQ(hash_map_frozen_get(frozen, "aloha", &value), KEY_ERROR);
+    hash_map_frozen_dtor(frozen);
+}
+
+TEST_F(EmptyHash, hash_map_freeze_values){
+    struct point { double x, y, z; };
+    std::string path = ::testing::TempDir() + "white_box_values.map";
+
+    // Plain map has no fixed-size values to freeze
+    ASSERT_EQ(hash_map_put(empty_hash, "home", 1), OK);
+    hash_map_frozen_t *plain = hash_map_freeze(empty_hash);
+    ASSERT_NE(plain, nullptr);
+    EXPECT_EQ(hash_map_frozen_get_value(plain, "home"), nullptr);
+    hash_map_frozen_dtor(plain);
+
+    hash_map_t *points = hash_map_ctor_with_value_size(sizeof(point));
+    ASSERT_NE(points, nullptr);
+    for (int i = 0; i < 1000; i++) {
+        point q = {(double)i, 2.0 * i, 3.0 * i};
+        ASSERT_EQ(hash_map_put_value(points, ("point" + std::to_string(i)).c_str(), &q), OK);
+    }
+    ASSERT_EQ(hash_map_put(points, "origin", 7), OK);
+    ASSERT_EQ(hash_map_save(points, path.c_str()), OK);
+
+    // Blocks travel with the keys, both in memory and in the mapped image
+    hash_map_frozen_t *frozen = hash_map_freeze(points);
+    ASSERT_NE(frozen, nullptr);
+    hash_map_dtor(points);
+    hash_map_frozen_t *mapped = hash_map_open_mmap(path.c_str());
+    ASSERT_NE(mapped, nullptr);
+    for (hash_map_frozen_t *table : {frozen, mapped}) {
+        for (int i = 0; i < 1000; i++) {
+            const point *q = (const point *)hash_map_frozen_get_value(
+                table, ("point" + std::to_string(i)).c_str());
+            ASSERT_NE(q, nullptr);
+            EXPECT_EQ((uintptr_t)q % 8, 0);
+            EXPECT_EQ(q->x, (double)i);
+            EXPECT_EQ(q->z, 3.0 * i);
+        }
+        int value;
+        const point *q = (const point *)hash_map_frozen_get_value(table, "origin");
+        ASSERT_NE(q, nullptr);
+        EXPECT_EQ(q->y, 0.0);
+        EXPECT_EQ(hash_map_frozen_get(table, "origin", &value), OK);
+        EXPECT_EQ(value, 7);
+        EXPECT_EQ(hash_map_frozen_get_value(table, "missing"), nullptr);
+    }
+    hash_map_frozen_dtor(mapped);
+    hash_map_frozen_dtor(frozen);
+    std::remove(path.c_str());
+}
+
+TEST_F(EmptyHash, hash_map_open_mmap){
+    std::string path = ::testing::TempDir() + "white_box_empty.map";
+    int value;
+
+    // Missing file cannot be opened
+    std::remove(path.c_str());
+    EXPECT_EQ(hash_map_open_mmap(path.c_str()), nullptr);
+
+    // Image of an empty table
+    ASSERT_EQ(hash_map_save(empty_hash, path.c_str()), OK);
+    hash_map_frozen_t *frozen = hash_map_open_mmap(path.c_str());
+    ASSERT_NE(frozen, nullptr);
+    EXPECT_EQ(hash_map_frozen_size(frozen), 0);
+    EXPECT_EQ(hash_map_frozen_get(frozen, "aloha", &value), KEY_ERROR);
+    hash_map_frozen_dtor(frozen);
+
+    // Truncated image or a different version is refused
+    FILE *file = fopen(path.c_str(), "r+b");
+    ASSERT_NE(file, nullptr);
+    uint32_t version = HASH_MAP_IMAGE_VERSION + 1;
+    fseek(file, 8, SEEK_SET);
+    fwrite(&version, sizeof(version), 1, file);
+    fclose(file);
+    EXPECT_EQ(hash_map_open_mmap(path.c_str()), nullptr);
+    file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fputs("HASHMAP", file);
+    fclose(file);
+    EXPECT_EQ(hash_map_open_mmap(path.c_str()), nullptr);
+    std::remove(path.c_str());
+
+    // Image cannot be written into a missing directory
+    std::string missing = ::testing::TempDir() + "white_box_missing/empty.map";
+    EXPECT_EQ(hash_map_save(empty_hash, missing.c_str()), IO_ERROR);
+}
+
+TEST_F(EmptyHash, hash_map_stats){
+    hash_map_stats_t stats;
+
+    // Fresh table, the first index allocation is not a resize
+    hash_map_stats(empty_hash, &stats);
+    EXPECT_EQ(stats.live, 0);
+    EXPECT_EQ(stats.capacity, HASH_MAP_INIT_SIZE);
+    EXPECT_EQ(stats.load_factor, 0.0);
+    EXPECT_EQ(stats.resizes, 0);
+    EXPECT_EQ(stats.key_bytes, 0);
+    for (size_t i = 0; i < HASH_MAP_STATS_PROBES; i++)
+        EXPECT_EQ(stats.probe_hits[i] + stats.probe_misses[i], 0);
+
+    // Growing the table counts resizes and memory
+    for (int i = 0; i < 100; i++)
+        ASSERT_EQ(hash_map_put(empty_hash, std::to_string(i).c_str(), i), OK);
+    hash_map_stats(empty_hash, &stats);
+    EXPECT_EQ(stats.live, 100);
+    EXPECT_GT(stats.resizes, 0);
+    EXPECT_DOUBLE_EQ(stats.load_factor, 100.0 / empty_hash->allocated);
+    EXPECT_EQ(stats.item_bytes, empty_hash->entries_allocated * sizeof(hash_map_item_t));
+    EXPECT_EQ(stats.key_bytes, 100 * HASH_MAP_SLAB_ALIGN);
+    EXPECT_GE(stats.index_bytes, empty_hash->allocated * (empty_hash->index_width + 1));
+
+    // Every insertion looked the key up and missed
+    size_t misses = 0;
+    for (size_t i = 0; i < HASH_MAP_STATS_PROBES; i++)
+        misses += stats.probe_misses[i];
+    EXPECT_EQ(misses, 100);
+
+    hash_map_stats_reset(empty_hash);
+    hash_map_stats(empty_hash, &stats);
+    EXPECT_EQ(stats.resizes, 0);
+    EXPECT_EQ(stats.rehash_ns, 0);
+    EXPECT_EQ(stats.probe_misses[0], 0);
+    EXPECT_EQ(stats.live, 100);
+}
+
+TEST_F(EmptyHash, hash_map_stats_incremental){
+    hash_map_stats_t stats;
+    int value;
+    hash_map_incremental_resize(empty_hash, true);
+
+    // Start a move between two indexes
+    ASSERT_EQ(hash_map_reserve(empty_hash, 1024), OK);
+    for (int i = 0; i <= 615; i++)
+        ASSERT_EQ(hash_map_put(empty_hash, ("key" + std::to_string(i)).c_str(), i), OK);
+    ASSERT_NE(empty_hash->old_index, nullptr);
+
+    // A lookup probing both indexes is counted once
+    hash_map_stats_reset(empty_hash);
+    for (int i = 0; i <= 615; i++)
+        ASSERT_EQ(hash_map_get(empty_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+    EXPECT_EQ(hash_map_get(empty_hash, "missing", &value), KEY_ERROR);
+    ASSERT_NE(empty_hash->old_index, nullptr);
+    hash_map_stats(empty_hash, &stats);
+    size_t hits = 0, misses = 0;
+    for (size_t i = 0; i < HASH_MAP_STATS_PROBES; i++) {
+        hits += stats.probe_hits[i];
+        misses += stats.probe_misses[i];
+    }
+    EXPECT_EQ(hits, 616);
+    EXPECT_EQ(misses, 1);
+
+    // Key memory follows insertions and removals, including large keys
+    std::string large(HASH_MAP_SLAB_MAX_BLOCK, 'x');
+    ASSERT_EQ(hash_map_put(empty_hash, large.c_str(), 1), OK);
+    hash_map_stats(empty_hash, &stats);
+    size_t large_bytes = stats.key_bytes - 616 * HASH_MAP_SLAB_ALIGN;
+    EXPECT_GT(large_bytes, HASH_MAP_SLAB_MAX_BLOCK);
+    for (int i = 0; i < 600; i++)
+        ASSERT_EQ(hash_map_remove(empty_hash, ("key" + std::to_string(i)).c_str()), OK);
+    hash_map_stats(empty_hash, &stats);
+    EXPECT_EQ(stats.key_bytes, 16 * HASH_MAP_SLAB_ALIGN + large_bytes);
+    ASSERT_EQ(hash_map_remove(empty_hash, large.c_str()), OK);
+    hash_map_stats(empty_hash, &stats);
+    EXPECT_EQ(stats.key_bytes, 16 * HASH_MAP_SLAB_ALIGN);
+    ASSERT_EQ(hash_map_put(empty_hash, large.c_str(), 1), OK);
+    hash_map_clear(empty_hash);
+    hash_map_stats(empty_hash, &stats);
+    EXPECT_EQ(stats.key_bytes, 0);
+}
+
 TEST_F(EmptyHash, hash_map_remove){
     // Delete non-existing key
     hash_map_state_code_t hash_code = hash_map_remove(empty_hash, "random");
@@ -292,6 +993,252 @@ TEST_F(NonEmptyHash, hash_map_put){
     EXPECT_EQ(hash_code, OK);
 }
 
+TEST_F(NonEmptyHash, hash_map_put_key_storage){
+    // Add long key
+    std::string long_key(200, 'x');
+    ASSERT_EQ(hash_map_put(non_empty_hash, long_key.c_str(), 1), OK);
+
+    // Items are stored densely in insertion order, keys are copied
+    size_t i = 0;
+    for (hash_map_item_t *item = hash_map_next(non_empty_hash, nullptr); item != nullptr;
+         item = hash_map_next(non_empty_hash, item), i++) {
+        EXPECT_EQ(item, non_empty_hash->entries + i);
+        EXPECT_STREQ(item->key, i < keys.size() ? keys[i] : long_key.c_str());
+        EXPECT_NE(item->key, i < keys.size() ? keys[i] : long_key.c_str());
+    }
+    EXPECT_EQ(i, keys.size() + 1);
+    EXPECT_EQ(non_empty_hash->last, non_empty_hash->entries + keys.size());
+}
+
+TEST_F(NonEmptyHash, hash_map_next){
+    int value;
+
+    // Removed items are skipped, the order of the others is kept
+    ASSERT_EQ(hash_map_pop(non_empty_hash, keys[0], &value), OK);
+    ASSERT_EQ(hash_map_pop(non_empty_hash, keys[2], &value), OK);
+    ASSERT_EQ(hash_map_put(non_empty_hash, keys[0], 7), OK);
+    std::vector<std::string> order;
+    for (hash_map_item_t *item = hash_map_next(non_empty_hash, nullptr); item != nullptr;
+         item = hash_map_next(non_empty_hash, item))
+        order.push_back(item->key);
+    ASSERT_EQ(order.size(), keys.size() - 1);
+    EXPECT_EQ(order.front(), keys[1]);
+    EXPECT_EQ(order.back(), keys[0]);
+    EXPECT_EQ(non_empty_hash->first->key, order.front());
+    EXPECT_EQ(non_empty_hash->last->key, order.back());
+
+    // Trailing removed items are released at once
+    size_t used = non_empty_hash->entries_used;
+    ASSERT_EQ(hash_map_pop(non_empty_hash, keys[0], &value), OK);
+    EXPECT_LT(non_empty_hash->entries_used, used);
+    EXPECT_NE(non_empty_hash->last->key, nullptr);
+}
+
+TEST_F(NonEmptyHash, hash_map_freeze){
+    int value;
+    uint64_t wide;
+
+    ASSERT_EQ(hash_map_pop(non_empty_hash, keys[3], &value), OK);
+    ASSERT_EQ(hash_map_put_u64(non_empty_hash, "wide", 0x123456789abcdef0ull), OK);
+    hash_map_frozen_t *frozen = hash_map_freeze(non_empty_hash);
+    ASSERT_NE(frozen, nullptr);
+    EXPECT_EQ(hash_map_frozen_size(frozen), keys.size());
+
+    // Every key owns exactly one slot
+    std::vector<std::string> stored;
+    for (size_t i = 0; i < frozen->count; i++) {
+        stored.emplace_back(frozen->keys + frozen->slots[i].key_offset, frozen->slots[i].key_len);
+        EXPECT_TRUE(hash_map_contains(non_empty_hash, stored.back().c_str()));
+    }
+    std::sort(stored.begin(), stored.end());
+    EXPECT_EQ(std::unique(stored.begin(), stored.end()), stored.end());
+
+    // The frozen table does not depend on the source table
+    ASSERT_EQ(hash_map_put(non_empty_hash, keys[3], 42), OK);
+    ASSERT_EQ(hash_map_remove(non_empty_hash, keys[0]), OK);
+    hash_map_dtor(non_empty_hash);
+    non_empty_hash = hash_map_ctor();
+
+    for (int i = 0; i < keys.size(); i++) {
+        if (i == 3) {
+            EXPECT_FALSE(hash_map_frozen_contains(frozen, keys[i]));
+            continue;
+        }
+        EXPECT_TRUE(hash_map_frozen_contains(frozen, keys[i]));
+        EXPECT_EQ(hash_map_frozen_get(frozen, keys[i], &value), OK);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(hash_map_frozen_get_u64(frozen, "wide", &wide), OK);
+    EXPECT_EQ(wide, 0x123456789abcdef0ull);
+    EXPECT_EQ(hash_map_frozen_get_bytes(frozen, "denx", 3, &value), OK);
+    EXPECT_EQ(value, 1);
+
+    // Keys with a different length or content are not found
+    EXPECT_EQ(hash_map_frozen_get(frozen, "dobr", &value), KEY_ERROR);
+    EXPECT_EQ(hash_map_frozen_get(frozen, "dobryy", &value), KEY_ERROR);
+    EXPECT_EQ(hash_map_frozen_get(frozen, "", &value), KEY_ERROR);
+    hash_map_frozen_dtor(frozen);
+}
+
+TEST_F(NonEmptyHash, hash_map_save){
+    std::string path = ::testing::TempDir() + "white_box_non_empty.map";
+    int value;
+    uint64_t wide;
+
+    ASSERT_EQ(hash_map_put_u64(non_empty_hash, "wide", 0x123456789abcdef0ull), OK);
+    ASSERT_EQ(hash_map_save(non_empty_hash, path.c_str()), OK);
+    hash_map_frozen_t *frozen = hash_map_open_mmap(path.c_str());
+    ASSERT_NE(frozen, nullptr);
+    EXPECT_NE(frozen->mapping, nullptr);
+    EXPECT_EQ(hash_map_frozen_size(frozen), keys.size() + 1);
+
+    // Records are read from the mapped file
+    EXPECT_GE((const char *)frozen->slots, (const char *)frozen->mapping);
+    EXPECT_LT((const char *)frozen->keys, (const char *)frozen->mapping + frozen->mapping_size);
+    for (int i = 0; i < keys.size(); i++) {
+        EXPECT_TRUE(hash_map_frozen_contains(frozen, keys[i]));
+        EXPECT_EQ(hash_map_frozen_get(frozen, keys[i], &value), OK);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(hash_map_frozen_get_u64(frozen, "wide", &wide), OK);
+    EXPECT_EQ(wide, 0x123456789abcdef0ull);
+    EXPECT_FALSE(hash_map_frozen_contains(frozen, "dobr"));
+
+    // Saving again replaces the file, the old mapping stays readable
+    ASSERT_EQ(hash_map_remove(non_empty_hash, keys[0]), OK);
+    ASSERT_EQ(hash_map_save(non_empty_hash, path.c_str()), OK);
+    EXPECT_EQ(hash_map_frozen_get(frozen, keys[0], &value), OK);
+    hash_map_frozen_t *reopened = hash_map_open_mmap(path.c_str());
+    ASSERT_NE(reopened, nullptr);
+    EXPECT_FALSE(hash_map_frozen_contains(reopened, keys[0]));
+    EXPECT_EQ(hash_map_frozen_get(reopened, keys[1], &value), OK);
+    EXPECT_EQ(value, 1);
+    hash_map_frozen_dtor(reopened);
+    hash_map_frozen_dtor(frozen);
+    std::remove(path.c_str());
+}
+
+TEST_F(NonEmptyHash, hash_map_open_mmap_truncated){
+    std::string path = ::testing::TempDir() + "white_box_truncated.map";
+    int value;
+
+    // Load the whole image
+    ASSERT_EQ(hash_map_save(non_empty_hash, path.c_str()), OK);
+    FILE *file = fopen(path.c_str(), "rb");
+    ASSERT_NE(file, nullptr);
+    std::string image;
+    char buffer[256];
+    for (size_t n; (n = fread(buffer, 1, sizeof(buffer), file)) > 0;)
+        image.append(buffer, n);
+    fclose(file);
+
+    // Image cut short does not match the header
+    file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(image.data(), 1, image.size() - 1, file);
+    fclose(file);
+    EXPECT_EQ(hash_map_open_mmap(path.c_str()), nullptr);
+
+    // Key region one byte short with a matching header, the last key points past the file
+    size_t cut = 1;
+    uint64_t data_size;
+    memcpy(&data_size, &image[48], sizeof(data_size));
+    data_size -= cut;
+    memcpy(&image[48], &data_size, sizeof(data_size));
+    file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(image.data(), 1, image.size() - cut, file);
+    fclose(file);
+    hash_map_frozen_t *frozen = hash_map_open_mmap(path.c_str());
+    ASSERT_NE(frozen, nullptr);
+    size_t found = 0;
+    for (int i = 0; i < keys.size(); i++) {
+        if (hash_map_frozen_get(frozen, keys[i], &value) == OK) {
+            EXPECT_EQ(value, i);
+            found++;
+        }
+    }
+    EXPECT_EQ(found, keys.size() - 1);
+    hash_map_frozen_dtor(frozen);
+
+    // Records with corrupted key offsets are not found
+    for (size_t i = 0; i < keys.size(); i++) {
+        uint32_t offset = UINT32_MAX - i;
+        memcpy(&image[72 + i*sizeof(hash_map_frozen_slot_t) + sizeof(uint64_t)], &offset, 
+               sizeof(offset));
+    }
+    file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(image.data(), 1, image.size() - cut, file);
+    fclose(file);
+    frozen = hash_map_open_mmap(path.c_str());
+    ASSERT_NE(frozen, nullptr);
+    for (int i = 0; i < keys.size(); i++)
+        EXPECT_EQ(hash_map_frozen_get(frozen, keys[i], &value), KEY_ERROR);
+    hash_map_frozen_dtor(frozen);
+    std::remove(path.c_str());
+}
+
+TEST_F(NonEmptyHash, hash_map_stats){
+    hash_map_stats_t stats;
+    int value;
+
+    hash_map_stats_reset(non_empty_hash);
+    for (int i = 0; i < keys.size(); i++)
+        ASSERT_EQ(hash_map_get(non_empty_hash, keys[i], &value), OK);
+    EXPECT_FALSE(hash_map_contains(non_empty_hash, "aloha"));
+    EXPECT_FALSE(hash_map_contains(non_empty_hash, "ahoj"));
+
+    // Histograms split hits and misses, short table means short probes
+    hash_map_stats(non_empty_hash, &stats);
+    EXPECT_EQ(stats.probe_hits[0], keys.size());
+    EXPECT_EQ(stats.probe_misses[0], 2);
+
+    // Removed items are reported as tombstones and dead entries
+    ASSERT_EQ(hash_map_pop(non_empty_hash, keys[0], &value), OK);
+    hash_map_stats(non_empty_hash, &stats);
+    EXPECT_EQ(stats.live, keys.size() - 1);
+    EXPECT_EQ(stats.tombstones, non_empty_hash->deleted);
+    EXPECT_EQ(stats.dead_entries, 1);
+}
+
+TEST_F(NonEmptyHash, hash_map_put_bytes){
+    int value;
+
+    // String keys are binary keys without the terminating zero
+    EXPECT_TRUE(hash_map_contains_bytes(non_empty_hash, "dobry", 5));
+    EXPECT_FALSE(hash_map_contains_bytes(non_empty_hash, "dobry", 6));
+    EXPECT_FALSE(hash_map_contains_bytes(non_empty_hash, "dobry", 4));
+    EXPECT_EQ(hash_map_put_bytes(non_empty_hash, "den", 3, 42), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_get(non_empty_hash, "den", &value), OK);
+    EXPECT_EQ(value, 42);
+
+    // Keys may contain zero bytes and differ only after them
+    const char first[] = {'i', 'd', '\0', 1};
+    const char second[] = {'i', 'd', '\0', 2};
+    EXPECT_EQ(hash_map_put_bytes(non_empty_hash, first, sizeof(first), 1), OK);
+    EXPECT_EQ(hash_map_put_bytes(non_empty_hash, second, sizeof(second), 2), OK);
+    EXPECT_EQ(hash_map_put_bytes(non_empty_hash, "id", 2, 3), OK);
+    EXPECT_EQ(hash_map_size(non_empty_hash), keys.size() + 3);
+    EXPECT_EQ(non_empty_hash->last->key_len, 2);
+    EXPECT_STREQ(non_empty_hash->last->key, "id");
+
+    EXPECT_EQ(hash_map_get_bytes(non_empty_hash, second, sizeof(second), &value), OK);
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(hash_map_pop_bytes(non_empty_hash, first, sizeof(first), &value), OK);
+    EXPECT_EQ(value, 1);
+    EXPECT_EQ(hash_map_remove_bytes(non_empty_hash, first, sizeof(first)), KEY_ERROR);
+    EXPECT_TRUE(hash_map_contains(non_empty_hash, "id"));
+
+    // Packed integer keys
+    for (uint64_t id = 0; id < 100; id++)
+        ASSERT_EQ(hash_map_put_bytes(non_empty_hash, &id, sizeof(id), (int)id), OK);
+    for (uint64_t id = 0; id < 100; id++) {
+        ASSERT_EQ(hash_map_get_bytes(non_empty_hash, &id, sizeof(id), &value), OK);
+        EXPECT_EQ(value, (int)id);
+    }
+}
+
 TEST_F(NonEmptyHash, hash_map_get){
     // Check first item
     ASSERT_NE(non_empty_hash->first, nullptr);
@@ -308,6 +1255,51 @@ TEST_F(NonEmptyHash, hash_map_get){
     EXPECT_EQ(value, 0);
 }
 
+TEST_F(NonEmptyHash, hash_map_get_many){
+    std::vector<const char*> lookup = keys;
+    lookup.push_back("random");
+    std::vector<int> values(lookup.size(), -1);
+    std::vector<hash_map_state_code_t> states(lookup.size());
+
+    // Existing keys are found, missing ones keep their value
+    EXPECT_EQ(hash_map_get_many(non_empty_hash, lookup.data(), lookup.size(), values.data(), states.data()), keys.size());
+    for (int i = 0; i < keys.size(); i++) {
+        EXPECT_EQ(states[i], OK);
+        EXPECT_EQ(values[i], i);
+    }
+    EXPECT_EQ(states.back(), KEY_ERROR);
+    EXPECT_EQ(values.back(), -1);
+
+    // States are optional
+    EXPECT_EQ(hash_map_get_many(non_empty_hash, lookup.data(), 0, values.data(), nullptr), 0);
+}
+
+TEST_F(NonEmptyHash, hash_map_put_many){
+    // More keys than a single batch
+    std::vector<std::string> names;
+    for (int i = 0; i < 3 * HASH_MAP_BATCH_SIZE; i++)
+        names.push_back("batch" + std::to_string(i));
+    names.push_back("dobry");
+    std::vector<const char*> batch;
+    std::vector<int> values;
+    for (int i = 0; i < names.size(); i++) {
+        batch.push_back(names[i].c_str());
+        values.push_back(100 + i);
+    }
+    std::vector<hash_map_state_code_t> states(batch.size());
+
+    EXPECT_EQ(hash_map_put_many(non_empty_hash, batch.data(), values.data(), batch.size(), states.data()), OK);
+    EXPECT_EQ(states.front(), OK);
+    EXPECT_EQ(states.back(), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_size(non_empty_hash), keys.size() + 3 * HASH_MAP_BATCH_SIZE);
+
+    // Items are appended in the order of the batch
+    EXPECT_STREQ(non_empty_hash->last->key, batch[batch.size() - 2]);
+    std::vector<int> found(batch.size());
+    EXPECT_EQ(hash_map_get_many(non_empty_hash, batch.data(), batch.size(), found.data(), nullptr), batch.size());
+    EXPECT_EQ(found, values);
+}
+
 TEST_F(NonEmptyHash, hash_map_pop){
     // Check first item
     ASSERT_NE(non_empty_hash->first, nullptr);
@@ -431,6 +1423,28 @@ TEST_F(CollisionHash, hash_map_contains){
     ASSERT_FALSE(hash_map_contains(collision_hash, "random2"));
 }
 
+TEST_F(CollisionHash, hash_map_stats){
+    hash_map_stats_t stats;
+    int value;
+
+    // Index full of removed slots makes every miss scan all groups
+    ASSERT_EQ(hash_map_reserve(collision_hash, 512), OK);
+    for (size_t i = 0; i < collision_hash->allocated; i++) {
+        if (collision_hash->ctrl[i] == HASH_MAP_CTRL_EMPTY) {
+            collision_hash->ctrl[i] = HASH_MAP_CTRL_DELETED;
+            collision_hash->deleted++;
+        }
+    }
+    hash_map_stats_reset(collision_hash);
+    EXPECT_EQ(hash_map_get(collision_hash, "random", &value), KEY_ERROR);
+    EXPECT_EQ(hash_map_get(collision_hash, keys[0], &value), OK);
+
+    hash_map_stats(collision_hash, &stats);
+    EXPECT_EQ(stats.probe_misses[HASH_MAP_STATS_PROBES - 1], 1);
+    EXPECT_EQ(stats.probe_hits[0], 1);
+    EXPECT_EQ(stats.tombstones, 512 - keys.size());
+}
+
 TEST_F(CollisionHash, hash_map_put){
     // Check first item
     ASSERT_NE(collision_hash->first, nullptr);
@@ -519,4 +1533,725 @@ TEST_F(CollisionHash, hash_map_remove){
     EXPECT_EQ(hash_code, KEY_ERROR);
 }
 
+/* ***************************** */
+/* **** ANAGRAM HASHTABLE ****** */
+/* ***************************** */
+TEST_F(AnagramHash, hash_function){
+    // Check all permutations were inserted
+    ASSERT_EQ(hash_map_size(anagram_hash), 5040);
+
+    // Anagrams must not share the hash
+    std::vector<size_t> hashes;
+    for (hash_map_item_t *item = hash_map_next(anagram_hash, nullptr); item != nullptr;
+         item = hash_map_next(anagram_hash, item))
+        hashes.push_back(item->hash);
+    std::sort(hashes.begin(), hashes.end());
+    EXPECT_EQ(std::adjacent_find(hashes.begin(), hashes.end()), hashes.end());
+}
+
+TEST_F(AnagramHash, probe_length){
+    // Check all permutations were inserted
+    ASSERT_EQ(hash_map_size(anagram_hash), 5040);
+
+    // Measure probe lengths of all items
+    size_t total = 0, longest = 0;
+    for (hash_map_item_t *item = hash_map_next(anagram_hash, nullptr); item != nullptr;
+         item = hash_map_next(anagram_hash, item)) {
+        size_t probes = probe_length(item);
+        total += probes;
+        longest = std::max(longest, probes);
+    }
+
+    // Load factor is ~0.31, nearly every item sits in its home group
+    EXPECT_LT((double)total / hash_map_size(anagram_hash), 1.1);
+    EXPECT_LT(longest, 4);
+}
+
+TEST_F(AnagramHash, control_bytes){
+    // Every occupied slot carries 7 bits of its item's hash
+    size_t full = 0;
+    for (size_t idx = 0; idx < anagram_hash->allocated; idx++) {
+        hash_map_item_t *item = slot_item(idx);
+        if (item == nullptr) {
+            EXPECT_EQ(anagram_hash->ctrl[idx], HASH_MAP_CTRL_EMPTY);
+            continue;
+        }
+        EXPECT_EQ(anagram_hash->ctrl[idx], item->hash & 0x7f);
+        full++;
+    }
+    EXPECT_EQ(full, hash_map_size(anagram_hash));
+
+    // Removed item leaves an empty slot or a counted tombstone behind
+    int value;
+    ASSERT_EQ(hash_map_pop(anagram_hash, "abcdefg", &value), OK);
+    size_t deleted = 0, free = 0;
+    for (size_t idx = 0; idx < anagram_hash->allocated; idx++) {
+        deleted += anagram_hash->ctrl[idx] == HASH_MAP_CTRL_DELETED;
+        free += anagram_hash->ctrl[idx] == HASH_MAP_CTRL_EMPTY || anagram_hash->ctrl[idx] == HASH_MAP_CTRL_DELETED;
+    }
+    EXPECT_EQ(deleted, anagram_hash->deleted);
+    EXPECT_EQ(free, anagram_hash->allocated - hash_map_size(anagram_hash));
+    EXPECT_FALSE(hash_map_contains(anagram_hash, "abcdefg"));
+    EXPECT_TRUE(hash_map_contains(anagram_hash, "gfedcba"));
+}
+
+TEST_F(AnagramHash, hash_map_get){
+    int value;
+
+    // Find first and last permutation
+    EXPECT_EQ(hash_map_get(anagram_hash, "abcdefg", &value), OK);
+    EXPECT_EQ(value, 0);
+    EXPECT_EQ(hash_map_get(anagram_hash, "gfedcba", &value), OK);
+    EXPECT_EQ(value, 5039);
+
+    // Find non-existing anagram
+    EXPECT_EQ(hash_map_get(anagram_hash, "abcdefh", &value), KEY_ERROR);
+}
+
+TEST_F(AnagramHash, hash_map_reserve){
+    int value;
+
+    // Rehash places items by their stored hash only
+    ASSERT_EQ(hash_map_reserve(anagram_hash, 65536), OK);
+    ASSERT_EQ(hash_map_reserve(anagram_hash, 8192), OK);
+    EXPECT_EQ(anagram_hash->deleted, 0);
+
+    size_t full = 0;
+    for (size_t idx = 0; idx < anagram_hash->allocated; idx++) {
+        hash_map_item_t *item = slot_item(idx);
+        if (item == nullptr)
+            continue;
+        EXPECT_EQ(anagram_hash->ctrl[idx], item->hash & 0x7f);
+        EXPECT_LT(probe_length(item), 4);
+        full++;
+    }
+    EXPECT_EQ(full, 5040);
+
+    // Every permutation is still found with its value
+    std::string key = "abcdefg";
+    int i = 0;
+    do {
+        ASSERT_EQ(hash_map_get(anagram_hash, key.c_str(), &value), OK);
+        EXPECT_EQ(value, i++);
+    } while (std::next_permutation(key.begin(), key.end()));
+}
+
+TEST_F(AnagramHash, hash_map_freeze){
+    int value;
+
+    hash_map_frozen_t *frozen = hash_map_freeze(anagram_hash);
+    ASSERT_NE(frozen, nullptr);
+    ASSERT_EQ(hash_map_frozen_size(frozen), 5040);
+
+    // Every permutation is found with its value
+    std::string key = "abcdefg";
+    int i = 0;
+    do {
+        ASSERT_EQ(hash_map_frozen_get(frozen, key.c_str(), &value), OK);
+        EXPECT_EQ(value, i++);
+    } while (std::next_permutation(key.begin(), key.end()));
+    EXPECT_FALSE(hash_map_frozen_contains(frozen, "abcdefh"));
+
+    // No free slots and no index, the frozen table is smaller than the source
+    size_t index_bytes = anagram_hash->allocated * (anagram_hash->index_width + 1);
+    EXPECT_LT(frozen->size, index_bytes + anagram_hash->entries_used * sizeof(hash_map_item_t));
+    EXPECT_LT(frozen->size, 5040 * (sizeof(hash_map_frozen_slot_t) + 8) + 4096);
+    hash_map_frozen_dtor(frozen);
+}
+
+TEST_F(AnagramHash, hash_map_save){
+    std::string path = ::testing::TempDir() + "white_box_anagram.map";
+    int value;
+
+    ASSERT_EQ(hash_map_save(anagram_hash, path.c_str()), OK);
+    hash_map_frozen_t *frozen = hash_map_open_mmap(path.c_str());
+    ASSERT_NE(frozen, nullptr);
+    ASSERT_EQ(hash_map_frozen_size(frozen), 5040);
+
+    // Every permutation is found in the mapped image
+    std::string key = "abcdefg";
+    int i = 0;
+    do {
+        ASSERT_EQ(hash_map_frozen_get(frozen, key.c_str(), &value), OK);
+        EXPECT_EQ(value, i++);
+    } while (std::next_permutation(key.begin(), key.end()));
+    EXPECT_FALSE(hash_map_frozen_contains(frozen, "abcdefh"));
+    hash_map_frozen_dtor(frozen);
+    std::remove(path.c_str());
+}
+
+/* ******************************* */
+/* **** ROBIN HOOD HASHTABLE ***** */
+/* ******************************* */
+TEST_F(RobinHoodHash, hash_map_ctor_with_probing){
+    int value;
+
+    // Every key is found, the table stays near the threshold
+    ASSERT_NE(robin_hood_hash, nullptr);
+    EXPECT_EQ(robin_hood_hash->probing, HASH_MAP_PROBING_ROBIN_HOOD);
+    EXPECT_EQ(hash_map_size(robin_hood_hash), key_count);
+    EXPECT_EQ(hash_map_capacity(robin_hood_hash), 2048);
+    for (int i = 0; i < key_count; i++) {
+        ASSERT_EQ(hash_map_get(robin_hood_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(hash_map_get(robin_hood_hash, "missing", &value), KEY_ERROR);
+    EXPECT_EQ(hash_map_put(robin_hood_hash, "key0", 42), KEY_ALREADY_EXISTS);
+
+    // Default construction keeps the group probing
+    hash_map_t *groups = hash_map_ctor();
+    EXPECT_EQ(groups->probing, HASH_MAP_PROBING_GROUPS);
+    hash_map_dtor(groups);
+}
+
+TEST_F(RobinHoodHash, displacement){
+    // Displacement keeps probe distances short and ordered
+    EXPECT_LT(robin_hood_hash->max_probe, 32);
+    check_displacement();
+}
+
+TEST_F(RobinHoodHash, hash_map_pop){
+    int value;
+
+    // Backward shift removes items without tombstones
+    for (int i = 0; i < key_count; i += 2)
+        ASSERT_EQ(hash_map_pop(robin_hood_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+    EXPECT_EQ(robin_hood_hash->deleted, 0);
+    check_displacement();
+
+    for (int i = 0; i < key_count; i++)
+        EXPECT_EQ(hash_map_contains(robin_hood_hash, ("key" + std::to_string(i)).c_str()), i % 2 == 1);
+
+    // Removed keys can be inserted again, also across a rehash
+    for (int i = 0; i < key_count; i += 2)
+        ASSERT_EQ(hash_map_put(robin_hood_hash, ("new" + std::to_string(i)).c_str(), i), OK);
+    EXPECT_EQ(hash_map_size(robin_hood_hash), key_count);
+    EXPECT_TRUE(hash_map_contains(robin_hood_hash, "key1"));
+    check_displacement();
+}
+
+/* ***************************** */
+/* **** ALLOCATOR HASHTABLE **** */
+/* ***************************** */
+TEST_F(AllocatorHash, hash_map_ctor_with_allocator){
+    // Map and its index come from the hooks
+    ASSERT_NE(allocator_hash, nullptr);
+    EXPECT_GE(allocations, 3);
+    EXPECT_EQ(hash_map_capacity(allocator_hash), 8);
+
+    // Destroy the map, the hooks must get everything back
+    hash_map_dtor(allocator_hash);
+    allocator_hash = nullptr;
+}
+
+TEST_F(AllocatorHash, hash_map_put){
+    // Reserve the index first so that only items are allocated
+    ASSERT_EQ(hash_map_reserve(allocator_hash, 4096), OK);
+    size_t before = allocations;
+
+    // Items are carved from few large chunks
+    for (int i = 0; i < 1000; i++)
+        ASSERT_EQ(hash_map_put(allocator_hash, ("key" + std::to_string(i)).c_str(), i), OK);
+    EXPECT_LT(allocations - before, 20);
+
+    // Long key bypasses the slab
+    before = allocations;
+    std::string long_key(1000, 'x');
+    ASSERT_EQ(hash_map_put(allocator_hash, long_key.c_str(), 1), OK);
+    EXPECT_EQ(allocations - before, 1);
+
+    int value;
+    EXPECT_EQ(hash_map_get(allocator_hash, "key999", &value), OK);
+    EXPECT_EQ(value, 999);
+}
+
+TEST_F(AllocatorHash, hash_map_pop){
+    ASSERT_EQ(hash_map_reserve(allocator_hash, 4096), OK);
+    for (int i = 0; i < 100; i++)
+        hash_map_put(allocator_hash, ("key" + std::to_string(i)).c_str(), i);
+
+    // Churn reuses freed items without touching the allocator
+    size_t before = allocations;
+    int value;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_EQ(hash_map_pop(allocator_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+        ASSERT_EQ(hash_map_put(allocator_hash, ("new" + std::to_string(i)).c_str(), i), OK);
+    }
+    EXPECT_EQ(allocations, before);
+}
+
+TEST_F(AllocatorHash, hash_map_reserve){
+    int value;
+    for (size_t i = 0; i < 100; i++)
+        ASSERT_EQ(hash_map_put(allocator_hash, ("key" + std::to_string(i)).c_str(), i), OK);
+    size_t capacity = hash_map_capacity(allocator_hash);
+
+    // Failed reserve keeps the index and does not raise the shrink floor
+    out_of_memory = true;
+    EXPECT_EQ(hash_map_reserve(allocator_hash, 4096), MEMORY_ERROR);
+    out_of_memory = false;
+    EXPECT_EQ(hash_map_capacity(allocator_hash), capacity);
+    for (size_t i = 0; i < 100; i++)
+        ASSERT_EQ(hash_map_pop(allocator_hash, ("key" + std::to_string(i)).c_str(), &value), OK);
+    EXPECT_LT(hash_map_capacity(allocator_hash), capacity);
+}
+
+TEST_F(AllocatorHash, hash_map_clear){
+    std::string long_key(1000, 'x');
+    for (int i = 0; i < 100; i++)
+        hash_map_put(allocator_hash, ("key" + std::to_string(i)).c_str(), i);
+    hash_map_put(allocator_hash, long_key.c_str(), 1);
+
+    // Only the map, its index and the entry array stay allocated
+    hash_map_clear(allocator_hash);
+    size_t index_bytes = hash_map_capacity(allocator_hash) * allocator_hash->index_width;
+    size_t entry_bytes = allocator_hash->entries_allocated * sizeof(hash_map_item_t);
+    EXPECT_EQ(live_bytes, sizeof(hash_map_t) + index_bytes + entry_bytes +
+                          (hash_map_capacity(allocator_hash) + 15) / 16 * 16);
+    EXPECT_EQ(hash_map_size(allocator_hash), 0);
+    EXPECT_FALSE(hash_map_contains(allocator_hash, "key1"));
+
+    // Map is usable after clearing
+    EXPECT_EQ(hash_map_put(allocator_hash, "key1", 1), OK);
+    EXPECT_TRUE(hash_map_contains(allocator_hash, "key1"));
+}
+
+/* ****************************** */
+/* **** CONCURRENT HASHTABLE **** */
+/* ****************************** */
+TEST_F(ConcurrentHash, hash_map_concurrent_ctor){
+    ASSERT_NE(concurrent_hash, nullptr);
+    EXPECT_EQ(concurrent_hash->shard_count, 8u);
+    EXPECT_EQ(concurrent_hash->shard_bits, 3u);
+    EXPECT_EQ((uintptr_t)concurrent_hash->shards % HASH_MAP_CACHE_LINE, 0u);
+    EXPECT_EQ(hash_map_concurrent_size(concurrent_hash), 0u);
+
+    // Shard count is rounded up to a power of two
+    hash_map_concurrent_t *rounded = hash_map_concurrent_ctor(5);
+    ASSERT_NE(rounded, nullptr);
+    EXPECT_EQ(rounded->shard_count, 8u);
+    hash_map_concurrent_dtor(rounded);
+
+    EXPECT_EQ(hash_map_concurrent_ctor(0), nullptr);
+}
+
+TEST_F(ConcurrentHash, hash_map_concurrent_put){
+    int value;
+
+    EXPECT_EQ(hash_map_concurrent_put(concurrent_hash, "aloha", 1), OK);
+    EXPECT_EQ(hash_map_concurrent_put(concurrent_hash, "aloha", 2), KEY_ALREADY_EXISTS);
+    EXPECT_TRUE(hash_map_concurrent_contains(concurrent_hash, "aloha"));
+    EXPECT_EQ(hash_map_concurrent_get(concurrent_hash, "aloha", &value), OK);
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(hash_map_concurrent_size(concurrent_hash), 1u);
+
+    EXPECT_EQ(hash_map_concurrent_pop(concurrent_hash, "aloha", &value), OK);
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(hash_map_concurrent_remove(concurrent_hash, "aloha"), KEY_ERROR);
+    EXPECT_EQ(hash_map_concurrent_get(concurrent_hash, "aloha", &value), KEY_ERROR);
+    EXPECT_FALSE(hash_map_concurrent_contains(concurrent_hash, "aloha"));
+}
+
+TEST_F(ConcurrentHash, shards){
+    for (size_t i = 0; i < 1000; i++)
+        ASSERT_EQ(hash_map_concurrent_put(concurrent_hash, key(0, i).c_str(), i), OK);
+
+    // Keys are spread over all shards
+    size_t size = 0;
+    for (size_t i = 0; i < concurrent_hash->shard_count; i++) {
+        EXPECT_GT(hash_map_size(concurrent_hash->shards[i].map), 1000u / 8 / 2);
+        size += hash_map_size(concurrent_hash->shards[i].map);
+    }
+    EXPECT_EQ(size, 1000u);
+
+    hash_map_concurrent_clear(concurrent_hash);
+    EXPECT_EQ(hash_map_concurrent_size(concurrent_hash), 0u);
+}
+
+TEST_F(ConcurrentHash, hash_map_stats){
+    hash_map_stats_t stats;
+    int value;
+
+    // Shards shared by readers do not count probes
+    ASSERT_EQ(hash_map_concurrent_put(concurrent_hash, key(0, 0).c_str(), 1), OK);
+    ASSERT_EQ(hash_map_concurrent_get(concurrent_hash, key(0, 0).c_str(), &value), OK);
+    for (size_t i = 0; i < concurrent_hash->shard_count; i++) {
+        hash_map_stats(concurrent_hash->shards[i].map, &stats);
+        for (size_t j = 0; j < HASH_MAP_STATS_PROBES; j++)
+            EXPECT_EQ(stats.probe_hits[j] + stats.probe_misses[j], 0u);
+    }
+}
+
+TEST_F(ConcurrentHash, hash_map_concurrent_increment){
+    std::vector<std::thread> threads;
+
+    // All threads update the same counters
+    for (size_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([this]() {
+            for (size_t i = 0; i < keys_per_thread; i++)
+                hash_map_concurrent_increment(concurrent_hash, key(0, i % 10).c_str(), 1, nullptr);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    int value;
+    EXPECT_EQ(hash_map_concurrent_size(concurrent_hash), 10u);
+    for (size_t i = 0; i < 10; i++) {
+        ASSERT_EQ(hash_map_concurrent_get(concurrent_hash, key(0, i).c_str(), &value), OK);
+        EXPECT_EQ((size_t)value, thread_count * keys_per_thread / 10);
+    }
+    EXPECT_EQ(hash_map_concurrent_increment(concurrent_hash, key(0, 0).c_str(), -1, &value), OK);
+    EXPECT_EQ((size_t)value, thread_count * keys_per_thread / 10 - 1);
+}
+
+TEST_F(ConcurrentHash, threads){
+    std::vector<std::thread> threads;
+
+    // Writers insert disjoint keys while readers look them up
+    for (size_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([this, t]() {
+            for (size_t i = 0; i < keys_per_thread; i++)
+                hash_map_concurrent_put(concurrent_hash, key(t, i).c_str(), i);
+        });
+        threads.emplace_back([this, t]() {
+            int value;
+            for (size_t i = 0; i < keys_per_thread; i++) {
+                if (hash_map_concurrent_get(concurrent_hash, key(t, i).c_str(), &value) == OK) {
+                    EXPECT_EQ((size_t)value, i);
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    EXPECT_EQ(hash_map_concurrent_size(concurrent_hash), thread_count * keys_per_thread);
+
+    // Every thread removes the odd keys of its neighbour
+    threads.clear();
+    for (size_t t = 0; t < thread_count; t++) {
+        threads.emplace_back([this, t]() {
+            size_t owner = (t + 1) % thread_count;
+            for (size_t i = 1; i < keys_per_thread; i += 2)
+                EXPECT_EQ(hash_map_concurrent_remove(concurrent_hash, key(owner, i).c_str()), OK);
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+
+    int value;
+    EXPECT_EQ(hash_map_concurrent_size(concurrent_hash), thread_count * keys_per_thread / 2);
+    for (size_t t = 0; t < thread_count; t++) {
+        for (size_t i = 0; i < keys_per_thread; i++) {
+            if (i % 2) {
+                EXPECT_FALSE(hash_map_concurrent_contains(concurrent_hash, key(t, i).c_str()));
+            } else {
+                ASSERT_EQ(hash_map_concurrent_get(concurrent_hash, key(t, i).c_str(), &value), OK);
+                EXPECT_EQ((size_t)value, i);
+            }
+        }
+    }
+}
+
+/* ***************************** */
+/* **** LRU CACHE HASHTABLE **** */
+/* ***************************** */
+TEST_F(CacheHash, hash_map_ctor_lru){
+    EXPECT_EQ(hash_map_ctor_lru(0, nullptr, nullptr), nullptr);
+    EXPECT_EQ(cache_hash->cache_capacity, 4);
+    EXPECT_EQ(hash_map_size(cache_hash), 4);
+    EXPECT_EQ(order(), "abcd");
+}
+
+TEST_F(CacheHash, hash_map_put){
+    // Full cache evicts the least recently used item first
+    ASSERT_EQ(hash_map_put(cache_hash, "e", 4), OK);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].first, "a");
+    EXPECT_EQ(evicted[0].second, 0);
+    EXPECT_EQ(hash_map_size(cache_hash), 4);
+    EXPECT_FALSE(hash_map_contains(cache_hash, "a"));
+    EXPECT_EQ(order(), "bcde");
+
+    // Updating an existing key uses it and evicts nothing
+    ASSERT_EQ(hash_map_put(cache_hash, "b", 10), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(evicted.size(), 1);
+    EXPECT_EQ(order(), "cdeb");
+}
+
+TEST_F(CacheHash, hash_map_get){
+    int value;
+
+    // Hit moves the item to the tail, contains does not
+    ASSERT_EQ(hash_map_get(cache_hash, "a", &value), OK);
+    EXPECT_EQ(value, 0);
+    EXPECT_TRUE(hash_map_contains(cache_hash, "b"));
+    EXPECT_EQ(order(), "bcda");
+    EXPECT_EQ(cache_hash->first->key, std::string("b"));
+    EXPECT_EQ(cache_hash->last->key, std::string("a"));
+
+    ASSERT_EQ(hash_map_put(cache_hash, "e", 4), OK);
+    ASSERT_EQ(evicted.size(), 1);
+    EXPECT_EQ(evicted[0].first, "b");
+    EXPECT_EQ(order(), "cdae");
+
+    // Miss changes nothing
+    EXPECT_EQ(hash_map_get(cache_hash, "b", &value), KEY_ERROR);
+    EXPECT_EQ(order(), "cdae");
+}
+
+TEST_F(CacheHash, compaction){
+    int value;
+
+    // Hit on a full entry array always moves the item, even when compacting
+    // the array alone would leave no free entry
+    for (size_t capacity : {5, 10}) {
+        hash_map_t *cache = hash_map_ctor_lru(capacity, on_evict, this);
+        ASSERT_NE(cache, nullptr);
+        std::vector<std::string> reference;
+        for (size_t i = 0; i < capacity; i++) {
+            reference.push_back("k" + std::to_string(i));
+            ASSERT_EQ(hash_map_put(cache, reference.back().c_str(), (int)i), OK);
+        }
+        for (int round = 0; round < 100; round++) {
+            // Use the oldest key, the second oldest is evicted next
+            std::string used = reference.front();
+            ASSERT_EQ(hash_map_get(cache, used.c_str(), &value), OK);
+            ASSERT_EQ(cache->last->key, used);
+            reference.erase(reference.begin());
+            reference.push_back(used);
+
+            std::string key = "n" + std::to_string(round);
+            ASSERT_EQ(hash_map_put(cache, key.c_str(), round), OK);
+            ASSERT_EQ(evicted.back().first, reference.front());
+            reference.erase(reference.begin());
+            reference.push_back(key);
+        }
+        EXPECT_EQ(hash_map_size(cache), capacity);
+        hash_map_dtor(cache);
+    }
+}
+
+TEST_F(CacheHash, churn){
+    std::vector<std::string> reference = {"a", "b", "c", "d"};
+    int value;
+
+    // Compare with a list kept in the order of use
+    hash_map_incremental_resize(cache_hash, true);
+    for (int i = 0; i < 20000; i++) {
+        std::string key = std::to_string(i * 7919 % 13);
+        auto it = std::find(reference.begin(), reference.end(), key);
+        bool hit = it != reference.end();
+        if (i % 3 == 0) {
+            ASSERT_EQ(hash_map_get(cache_hash, key.c_str(), &value), hit ? OK : KEY_ERROR);
+            if (!hit)
+                continue;
+            reference.erase(it);
+        } else {
+            ASSERT_EQ(hash_map_put(cache_hash, key.c_str(), i), hit ? KEY_ALREADY_EXISTS : OK);
+            if (hit) {
+                reference.erase(it);
+            } else if (reference.size() == 4) {
+                ASSERT_EQ(evicted.back().first, reference.front());
+                reference.erase(reference.begin());
+            }
+        }
+        reference.push_back(key);
+        std::string keys;
+        for (auto &k : reference)
+            keys += k;
+        ASSERT_EQ(order(), keys);
+    }
+
+    // Moved items leave dead entries, the array stays bounded
+    EXPECT_LE(hash_map_size(cache_hash), 4);
+    EXPECT_LT(cache_hash->entries_allocated, 64);
+}
+
+/* ********************************** */
+/* **** INTEGER KEY HASHTABLE ******* */
+/* ********************************** */
+TEST_F(IntegerHash, hash_map_u64_put){
+    int value;
+
+    EXPECT_EQ(hash_map_u64_size(integer_hash), 1000);
+    EXPECT_LE(hash_map_u64_size(integer_hash), hash_map_u64_capacity(integer_hash) * (HASH_MAP_REALLOCATION_THRESHOLD));
+
+    // Existing key is overwritten, key 0 is an ordinary key
+    EXPECT_EQ(hash_map_u64_put(integer_hash, key(5), 50), KEY_ALREADY_EXISTS);
+    EXPECT_EQ(hash_map_u64_get(integer_hash, key(5), &value), OK);
+    EXPECT_EQ(value, 50);
+    EXPECT_EQ(hash_map_u64_get(integer_hash, 0, &value), OK);
+    EXPECT_EQ(value, 0);
+    EXPECT_EQ(hash_map_u64_put(integer_hash, UINT64_MAX, -1), OK);
+    EXPECT_TRUE(hash_map_u64_contains(integer_hash, UINT64_MAX));
+    EXPECT_EQ(hash_map_u64_size(integer_hash), 1001);
+}
+
+TEST_F(IntegerHash, hash_map_u64_get){
+    int value;
+
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(hash_map_u64_get(integer_hash, key(i), &value), OK);
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_EQ(hash_map_u64_get(integer_hash, key(1000), &value), KEY_ERROR);
+    EXPECT_EQ(hash_map_u64_get(integer_hash, key(1) + 1, &value), KEY_ERROR);
+    EXPECT_FALSE(hash_map_u64_contains(integer_hash, 1));
+}
+
+TEST_F(IntegerHash, hash_map_u64_pop){
+    int value;
+
+    // Removing every other key keeps the rest reachable
+    for (int i = 0; i < 1000; i += 2)
+        ASSERT_EQ(hash_map_u64_pop(integer_hash, key(i), &value), OK);
+    EXPECT_EQ(hash_map_u64_pop(integer_hash, key(0), &value), KEY_ERROR);
+    EXPECT_EQ(hash_map_u64_remove(integer_hash, key(1)), OK);
+    EXPECT_EQ(hash_map_u64_size(integer_hash), 499);
+    for (int i = 3; i < 1000; i += 2) {
+        ASSERT_EQ(hash_map_u64_get(integer_hash, key(i), &value), OK);
+        EXPECT_EQ(value, i);
+    }
+
+    // Index shrinks when almost empty, removed slots are reused
+    size_t capacity = hash_map_u64_capacity(integer_hash);
+    for (int i = 3; i < 1000; i += 2)
+        ASSERT_EQ(hash_map_u64_remove(integer_hash, key(i)), OK);
+    EXPECT_LT(hash_map_u64_capacity(integer_hash), capacity);
+    EXPECT_EQ(hash_map_u64_size(integer_hash), 0);
+    for (int round = 0; round < 100; round++) {
+        ASSERT_EQ(hash_map_u64_put(integer_hash, round, round), OK);
+        ASSERT_EQ(hash_map_u64_pop(integer_hash, round, &value), OK);
+    }
+    EXPECT_LE(hash_map_u64_capacity(integer_hash), 64);
+}
+
+TEST_F(IntegerHash, hash_map_u64_increment){
+    int value;
+
+    EXPECT_EQ(hash_map_u64_increment(integer_hash, key(7), 3, &value), OK);
+    EXPECT_EQ(value, 10);
+    EXPECT_EQ(hash_map_u64_increment(integer_hash, 42, 3, nullptr), OK);
+    EXPECT_EQ(hash_map_u64_get(integer_hash, 42, &value), OK);
+    EXPECT_EQ(value, 3);
+}
+
+TEST_F(IntegerHash, hash_map_u64_reserve){
+    int value;
+
+    EXPECT_EQ(hash_map_u64_reserve(integer_hash, 10), VALUE_ERROR);
+    ASSERT_EQ(hash_map_u64_reserve(integer_hash, 4096), OK);
+    EXPECT_EQ(hash_map_u64_capacity(integer_hash), 4096);
+    EXPECT_EQ(integer_hash->deleted, 0);
+    for (int i = 0; i < 1000; i++) {
+        ASSERT_EQ(hash_map_u64_get(integer_hash, key(i), &value), OK);
+        EXPECT_EQ(value, i);
+    }
+
+    hash_map_u64_clear(integer_hash);
+    EXPECT_EQ(hash_map_u64_size(integer_hash), 0);
+    EXPECT_EQ(hash_map_u64_capacity(integer_hash), 4096);
+    EXPECT_FALSE(hash_map_u64_contains(integer_hash, key(1)));
+}
+
+TEST_F(IntegerHash, hash_map_u64_reserve_failure){
+    int value;
+    size_t capacity = hash_map_u64_capacity(integer_hash);
+
+    // Failed reserve keeps the index and does not raise the shrink floor
+    EXPECT_EQ(hash_map_u64_reserve(integer_hash, SIZE_MAX / 2), MEMORY_ERROR);
+    EXPECT_EQ(hash_map_u64_capacity(integer_hash), capacity);
+    for (int i = 0; i < 1000; i++)
+        ASSERT_EQ(hash_map_u64_pop(integer_hash, key(i), &value), OK);
+    EXPECT_LT(hash_map_u64_capacity(integer_hash), capacity);
+}
+
+/* *************************** */
+/* **** C++ HASHTABLE ********* */
+/* *************************** */
+TEST_F(WrapperHash, lookup){
+    // Lookup by string_view does not need terminated keys
+    std::string text = "jak se mate";
+    EXPECT_TRUE(map.contains(std::string_view(text).substr(0, 3)));
+    EXPECT_EQ(map.get(std::string_view(text).substr(4, 2)), 3);
+    EXPECT_EQ(map.get(std::string_view(text).substr(4, 4)), std::nullopt);
+    EXPECT_FALSE(map.contains(""));
+    EXPECT_EQ(map.size(), keys.size());
+    EXPECT_FALSE(map.empty());
+
+    // Erase by string_view
+    EXPECT_TRUE(map.erase(std::string_view(text).substr(7)));
+    EXPECT_FALSE(map.erase("mate"));
+    EXPECT_EQ(map.size(), keys.size() - 1);
+}
+
+TEST_F(WrapperHash, try_emplace){
+    // Existing key keeps its value
+    auto [value, inserted] = map.try_emplace("den", 42);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(*value, 1);
+
+    // Missing key is inserted with the value
+    std::tie(value, inserted) = map.try_emplace("pane", 42);
+    EXPECT_TRUE(inserted);
+    EXPECT_EQ(*value, 42);
+    *value = 7;
+    EXPECT_EQ(map.get("pane"), 7);
+
+    // Subscript inserts zero and counts
+    for (int i = 0; i < 3; i++)
+        map["counter"]++;
+    EXPECT_EQ(map["counter"], 3);
+    EXPECT_FALSE(map.insert_or_assign("counter", 10));
+    EXPECT_EQ(map.get("counter"), 10);
+}
+
+TEST_F(WrapperHash, iteration){
+    // Range-for visits items in insertion order
+    map.erase("den");
+    map.insert_or_assign("den", 10);
+    std::vector<std::string> order;
+    for (auto [key, value] : map) {
+        order.emplace_back(key);
+        value++;
+    }
+    ASSERT_EQ(order.size(), keys.size());
+    EXPECT_EQ(order.front(), "dobry");
+    EXPECT_EQ(order.back(), "den");
+    EXPECT_EQ(map.get("den"), 11);
+    EXPECT_EQ(std::distance(map.begin(), map.end()), keys.size());
+
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.begin(), map.end());
+}
+
+TEST_F(WrapperHash, reserve){
+    // Reserve counts items, not index slots, and never shrinks
+    map.reserve(1000);
+    size_t capacity = map.capacity();
+    EXPECT_GE(capacity * HASH_MAP_REALLOCATION_THRESHOLD, 1000);
+    for (int i = 0; i < 1000 - keys.size(); i++)
+        map.insert_or_assign("key" + std::to_string(i), i);
+    EXPECT_EQ(map.capacity(), capacity);
+    map.reserve(10);
+    EXPECT_EQ(map.capacity(), capacity);
+}
+
+TEST_F(WrapperHash, move){
+    // Ownership moves with the object
+    hash_map_t *native = map.native();
+    HashMap moved(std::move(map));
+    EXPECT_EQ(moved.native(), native);
+    EXPECT_EQ(moved.get("dobry"), 0);
+
+    HashMap other(HASH_MAP_PROBING_ROBIN_HOOD);
+    other["robin"] = 1;
+    other = std::move(moved);
+    EXPECT_EQ(other.native(), native);
+    EXPECT_FALSE(other.contains("robin"));
+    EXPECT_EQ(other.size(), keys.size());
+}
+
 /*** Konec souboru white_box_tests.cpp ***/